@@ -0,0 +1,91 @@
+#include "Crc32c.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  include <nmmintrin.h>
+#  define CRC32C_X86_64
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#  include <arm_acle.h>
+#  define CRC32C_ARM64
+#endif
+
+namespace {
+
+constexpr quint32 Polynomial = 0x82F63B78;  // reflected Castagnoli polynomial
+
+struct Table {
+    quint32 entries[256];
+
+    Table()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (crc & 1 ? Polynomial : 0);
+            entries[i] = crc;
+        }
+    }
+};
+
+quint32 crc32cSoftware(quint32 crc, const uchar *p, qsizetype size)
+{
+    static const Table table;
+    while (size--)
+        crc = table.entries[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(CRC32C_X86_64)
+
+__attribute__((target("sse4.2")))
+quint32 crc32cHardware(quint32 crc, const uchar *p, qsizetype size)
+{
+    quint64 wide = crc;
+    for (; size >= 8; p += 8, size -= 8) {
+        quint64 word;
+        std::memcpy(&word, p, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = quint32(wide);
+    while (size--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+bool hasHardwareCrc()
+{
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+
+#elif defined(CRC32C_ARM64)
+
+quint32 crc32cHardware(quint32 crc, const uchar *p, qsizetype size)
+{
+    for (; size >= 8; p += 8, size -= 8) {
+        quint64 word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    while (size--)
+        crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+// Compiled for a target that guarantees the CRC extension
+bool hasHardwareCrc() { return true; }
+
+#endif
+
+} // namespace
+
+quint32 crc32c(const void *data, qsizetype size)
+{
+    const uchar *p = static_cast<const uchar *>(data);
+    quint32 crc = 0xFFFFFFFF;
+#if defined(CRC32C_X86_64) || defined(CRC32C_ARM64)
+    if (hasHardwareCrc())
+        return ~crc32cHardware(crc, p, size);
+#endif
+    return ~crc32cSoftware(crc, p, size);
+}
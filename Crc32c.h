@@ -0,0 +1,11 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <QtGlobal>
+
+// CRC-32C (Castagnoli), as used by iSCSI, ext4 and SCTP. Uses the SSE4.2
+// or ARMv8 CRC instructions when the CPU has them, a lookup table
+// otherwise; both give the same result.
+quint32 crc32c(const void *data, qsizetype size);
+
+#endif // CRC32C_H
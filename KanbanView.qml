@@ -19,7 +19,7 @@ Item {
     property color warningOrange: "#ff8c00"
     property color dangerRed: "#ff3366"
 
-    signal deleteTaskRequested(int taskId, string taskName)
+    signal deleteTaskRequested(double taskId, string taskName)
 
     Component.onCompleted: {
         console.log("[KANBAN ROOT] model =", kanbanTaskModel)
@@ -120,92 +120,16 @@ Item {
 
         /* ---- STATE ---- */
 
-        property int visibleCount: 0
-        property var filteredModel: ListModel {}
-        property bool isRebuildingSuppressed: false
-
-        // Function to rebuild filtered model
-        function rebuildFilteredModel() {
-            if (isRebuildingSuppressed) {
-                console.log("[COLUMN]", title, "rebuild suppressed")
-                return
-            }
-
-            console.log("[COLUMN]", title, "rebuilding filtered model...")
-
-            var oldCount = filteredModel.count
-            filteredModel.clear()
-
-            if (!model) {
-                visibleCount = 0
-                return
-            }
-
-            var statusRole = Qt.UserRole + 4  // TaskStatusRole
-            var idRole = Qt.UserRole + 1      // TaskIdRole
-            var nameRole = Qt.UserRole + 2    // TaskNameRole
-            var descRole = Qt.UserRole + 3    // TaskDescriptionRole
-
-            var count = 0
-            for (var i = 0; i < model.rowCount(); i++) {
-                var idx = model.index(i, 0)
-                var status = model.data(idx, statusRole)
-
-                if (status === statusFilter) {
-                    filteredModel.append({
-                        "taskId": model.data(idx, idRole),
-                        "taskName": model.data(idx, nameRole),
-                        "taskDescription": model.data(idx, descRole),
-                        "taskStatus": status,
-                        "sourceIndex": i
-                    })
-                    count++
-                }
-            }
-
-            visibleCount = count
-            console.log("[COLUMN]", title, "filtered model rebuilt, old count:", oldCount, "new count:", visibleCount)
-        }
-
-        // Smart update: only rebuild if our status is affected
-        function smartUpdate(affectedStatuses) {
-            if (!affectedStatuses || affectedStatuses.indexOf(statusFilter) !== -1) {
-                rebuildFilteredModel()
-            } else {
-                console.log("[COLUMN]", title, "skipping rebuild - not affected")
-            }
-        }
-
-        // Update filtered model when source model changes
-        Connections {
-            target: model
-
-            function onRowsInserted() {
-                column.rebuildFilteredModel()
-            }
-
-            function onRowsRemoved() {
-                column.rebuildFilteredModel()
-            }
-
-            function onModelReset() {
-                column.rebuildFilteredModel()
-            }
-
-            function onDataChanged(topLeft, bottomRight, roles) {
-                // Only rebuild if status changed
-                var statusRole = Qt.UserRole + 4
-                if (!roles || roles.length === 0 || roles.indexOf(statusRole) !== -1) {
-                    column.rebuildFilteredModel()
-                }
-            }
-        }
-
-        Component.onCompleted: {
-            console.log("[COLUMN]", title)
-            console.log("  model =", model)
-            console.log("  count =", model ? model.count : "NO MODEL")
-            rebuildFilteredModel()
+        // Filtered in C++; a status change moves one row between columns.
+        // Rows are paged in as the list scrolls (the filter fetches until it
+        // has a page of matches), so the header shows the model's running
+        // total for the status instead of the row count
+        property int visibleCount: statusFilter === 0 ? model.pendingCount
+                                 : statusFilter === 1 ? model.inProgressCount
+                                 : model.completedCount
+        property TaskStatusFilterModel filteredModel: TaskStatusFilterModel {
+            sourceModel: column.model
+            status: column.statusFilter
         }
 
         ColumnLayout {
@@ -475,7 +399,7 @@ Item {
                                 Drag.hotSpot.y: height / 2
                                 Drag.keys: ["kanbanTask"]
 
-                                property int draggedTaskId: taskId
+                                property double draggedTaskId: taskId
                                 property int draggedTaskStatus: taskStatus
 
                                 Rectangle {
@@ -2,6 +2,7 @@ import QtQuick
 import QtQuick.Controls
 import QtQuick.Layouts
 import QtQuick.Effects
+import QtCore
 
 ApplicationWindow {
     id: root
@@ -25,6 +26,25 @@ ApplicationWindow {
 
     property bool isKanbanView: false
 
+    onIsKanbanViewChanged: {
+        if (isKanbanView)
+            kanbanLoader.active = true
+    }
+
+    // The dialogs are only created once they are first needed
+    function openAddTaskDialog() {
+        addTaskDialogLoader.active = true
+        addTaskDialogLoader.item.open()
+    }
+
+    function confirmDelete(taskId, taskName) {
+        deleteConfirmDialogLoader.active = true
+        var dialog = deleteConfirmDialogLoader.item
+        dialog.taskIdToDelete = taskId
+        dialog.taskNameToDelete = taskName
+        dialog.open()
+    }
+
     Component.onDestruction: {
         console.log("Saving tasks...")
         taskModel.saveToFile()
@@ -90,6 +110,17 @@ ApplicationWindow {
                 color: accentCyan
                 opacity: 0.3
             }
+
+            // Load progress while tasks stream in from disk
+            Rectangle {
+                anchors.bottom: parent.bottom
+                width: parent.width * taskModel.loadProgress
+                height: 2
+                color: accentCyan
+                visible: taskModel.loading
+
+                Behavior on width { NumberAnimation { duration: 150 } }
+            }
         }
 
         RowLayout {
@@ -189,14 +220,14 @@ ApplicationWindow {
 
                 StatCard {
                     label: "ACTIVE"
-                    value: getActiveCount()
+                    value: taskModel.activeCount
                     iconText: "⚡"
                     glowColor: warningOrange
                 }
 
                 StatCard {
                     label: "DONE"
-                    value: getCompletedCount()
+                    value: taskModel.completedCount
                     iconText: "✓"
                     glowColor: successGreen
                 }
@@ -234,7 +265,7 @@ ApplicationWindow {
                     verticalAlignment: Text.AlignVCenter
                 }
 
-                onClicked: addTaskDialog.open()
+                onClicked: openAddTaskDialog()
             }
         }
     }
@@ -285,6 +316,58 @@ ApplicationWindow {
                     }
                 }
 
+                TextField {
+                    id: searchField
+                    Layout.preferredWidth: 260
+                    placeholderText: "🔍 Search tasks..."
+                    placeholderTextColor: textSecondary
+                    color: textPrimary
+                    font.pixelSize: 13
+                    selectByMouse: true
+                    background: Rectangle { radius: 8; color: bgCard; border.width: 1; border.color: searchField.activeFocus ? accentCyan : Qt.rgba(0, 0.85, 1, 0.3) }
+                }
+
+                // Batch actions on the selected tasks
+                Button {
+                    visible: taskListView.selectedIds.length > 0
+                    text: "✓ COMPLETE (" + taskListView.selectedIds.length + ")"
+                    font.pixelSize: 12
+                    font.bold: true
+                    background: Rectangle { radius: 8; color: bgCard; border.width: 1; border.color: successGreen; opacity: parent.hovered ? 1 : 0.7; Behavior on opacity { NumberAnimation { duration: 200 } } }
+                    contentItem: Text { text: parent.text; font: parent.font; color: successGreen; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                    onClicked: {
+                        taskModel.setStatus(taskListView.selectedIds, 2)
+                        taskListView.selectedIds = []
+                    }
+                }
+
+                Button {
+                    visible: taskListView.selectedIds.length > 0
+                    text: "✕ DELETE (" + taskListView.selectedIds.length + ")"
+                    font.pixelSize: 12
+                    font.bold: true
+                    background: Rectangle { radius: 8; color: bgCard; border.width: 1; border.color: dangerRed; opacity: parent.hovered ? 1 : 0.7; Behavior on opacity { NumberAnimation { duration: 200 } } }
+                    contentItem: Text { text: parent.text; font: parent.font; color: dangerRed; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                    onClicked: {
+                        taskModel.removeTasks(taskListView.selectedIds)
+                        taskListView.selectedIds = []
+                        deleteNotification.show()
+                    }
+                }
+
+                Button {
+                    visible: taskModel.completedCount > 0
+                    text: "🧹 CLEAR DONE"
+                    font.pixelSize: 12
+                    font.bold: true
+                    background: Rectangle { radius: 8; color: bgCard; border.width: 1; border.color: warningOrange; opacity: parent.hovered ? 1 : 0.7; Behavior on opacity { NumberAnimation { duration: 200 } } }
+                    contentItem: Text { text: parent.text; font: parent.font; color: warningOrange; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                    onClicked: {
+                        taskModel.removeTasks(taskModel.taskIdsWithStatus(2))
+                        deleteNotification.show()
+                    }
+                }
+
                 Item { Layout.fillWidth: true }
 
                 Button {
@@ -308,7 +391,7 @@ ApplicationWindow {
                     font.bold: true
                     background: Rectangle { radius: 8; color: bgCard; border.width: 1; border.color: accentPurple; opacity: parent.hovered ? 1 : 0.7; Behavior on opacity { NumberAnimation { duration: 200 } } }
                     contentItem: Text { text: parent.text; font: parent.font; color: accentPurple; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
-                    onClicked: { taskModel.saveToFile(); saveNotification.show() }
+                    onClicked: { saveNotification.pending = true; taskModel.saveToFile() }
                 }
             }
         }
@@ -329,7 +412,21 @@ ApplicationWindow {
                 spacing: 12
                 clip: true
                 property int currentFilter: -1
-                model: taskModel
+                property var selectedIds: []
+
+                function setSelected(id, selected) {
+                    var ids = selectedIds.filter(function(other) { return other !== id })
+                    if (selected)
+                        ids.push(id)
+                    selectedIds = ids
+                }
+                model: TaskStatusFilterModel {
+                    status: taskListView.currentFilter
+                    sourceModel: TaskSearchFilterModel {
+                        sourceModel: taskModel
+                        query: searchField.text
+                    }
+                }
 
                 ScrollBar.vertical: ScrollBar {
                     policy: ScrollBar.AsNeeded
@@ -343,18 +440,14 @@ ApplicationWindow {
                 delegate: Item {
                     id: delegateRoot
                     width: taskListView.width
-                    height: taskCard.visible ? taskCard.implicitHeight : 0
-
-                    property bool matchesFilter: taskListView.currentFilter === -1 || taskStatus === taskListView.currentFilter
+                    height: taskCard.implicitHeight
 
                     Rectangle {
                         id: taskCard
                         anchors.left: parent.left
                         anchors.right: parent.right
                         anchors.top: parent.top
-                        implicitHeight: visible ? cardContent.implicitHeight + 40 : 0
-                        visible: delegateRoot.matchesFilter
-                        opacity: visible ? 1 : 0
+                        implicitHeight: cardContent.implicitHeight + 40
 
                         color: bgCard
                         radius: 15
@@ -411,6 +504,12 @@ ApplicationWindow {
                             anchors.leftMargin: 30
                             spacing: 20
 
+                            CheckBox {
+                                Layout.alignment: Qt.AlignVCenter
+                                checked: taskListView.selectedIds.indexOf(taskId) !== -1
+                                onToggled: taskListView.setSelected(taskId, checked)
+                            }
+
                             // Status indicator (FIXED)
                             Rectangle {
                                 Layout.alignment: Qt.AlignVCenter
@@ -488,13 +587,13 @@ ApplicationWindow {
                                     spacing: 12
 
                                     MetaTag {
-                                        text: "🎯 " + taskModel.priorityToString(taskPriority)
+                                        text: "🎯 " + priorityLabel
                                         tagColor: taskPriority === 2 ? dangerRed :
                                                  taskPriority === 1 ? warningOrange : successGreen
                                     }
 
                                     MetaTag {
-                                        text: "⚡ " + taskModel.statusToString(taskStatus)
+                                        text: "⚡ " + statusLabel
                                         tagColor: isCompleted ? successGreen :
                                                  taskStatus === 1 ? warningOrange : accentCyan
                                     }
@@ -503,6 +602,18 @@ ApplicationWindow {
                                         text: "📅 " + createdTime
                                         tagColor: Qt.rgba(0.55, 0.57, 0.72, 1)
                                     }
+
+                                    MetaTag {
+                                        text: (isOverdue ? "⏰ Overdue " : "⏳ Due ") + dueTime
+                                        tagColor: isOverdue ? dangerRed : accentCyan
+                                        visible: dueTime !== ""
+                                    }
+
+                                    MetaTag {
+                                        text: "⛓ Blocked"
+                                        tagColor: accentPurple
+                                        visible: isBlocked
+                                    }
                                 }
                             }
 
@@ -530,11 +641,7 @@ ApplicationWindow {
                                 ActionButton {
                                     text: "✕ DELETE"
                                     buttonColor: dangerRed
-                                    onClicked: {
-                                        deleteConfirmDialog.taskIdToDelete = taskId
-                                        deleteConfirmDialog.taskNameToDelete = taskName
-                                        deleteConfirmDialog.open()
-                                    }
+                                    onClicked: confirmDelete(taskId, taskName)
                                     Layout.preferredWidth: 120
                                 }
                             }
@@ -552,7 +659,7 @@ ApplicationWindow {
 
                 Label {
                     anchors.centerIn: parent
-                    visible: taskListView.count === 0
+                    visible: taskModel.count === 0
                     text: "No tasks yet.\nClick + to add your first task!"
                     font.pixelSize: 18
                     color: textSecondary
@@ -560,102 +667,80 @@ ApplicationWindow {
                 }
             }
 
-            // Kanban View (from the separate file)
-            KanbanView {
+            // Kanban View (from the separate file), built the first time it
+            // is shown and kept afterwards
+            Loader {
+                id: kanbanLoader
                 anchors.fill: parent
+                active: false
                 visible: isKanbanView
-                kanbanTaskModel: taskModel
 
-                // Connect the delete signal to your dialog
-                onDeleteTaskRequested: (taskId, taskName) => {
-                    deleteConfirmDialog.taskIdToDelete = taskId
-                    deleteConfirmDialog.taskNameToDelete = taskName
-                    deleteConfirmDialog.open()
+                sourceComponent: KanbanView {
+                    kanbanTaskModel: taskModel
+
+                    // Connect the delete signal to your dialog
+                    onDeleteTaskRequested: (taskId, taskName) => confirmDelete(taskId, taskName)
                 }
             }
         }
     }
 
     // Add Task Dialog
-    Dialog {
-        id: addTaskDialog
-        anchors.centerIn: parent
-        width: 500
-        modal: true
-
-        background: Rectangle {
-            color: bgMedium
-            radius: 20
-            border.width: 2
-            border.color: accentCyan
-
-            layer.enabled: true
-            layer.effect: MultiEffect {
-                shadowEnabled: true
-                shadowColor: Qt.rgba(0, 0.85, 1, 0.5)
-                shadowBlur: 0.5
-            }
-        }
-
-        header: Item {
-            height: 60
-
-            Label {
-                anchors.centerIn: parent
-                text: "CREATE NEW TASK"
-                font.pixelSize: 20
-                font.bold: true
-                font.letterSpacing: 2
-                color: textPrimary
-            }
-        }
+    Loader {
+        id: addTaskDialogLoader
+        active: false
 
-        contentItem: ColumnLayout {
-            spacing: 20
-
-            Label {
-                text: "TASK NAME"
-                font.pixelSize: 12
-                font.bold: true
-                font.letterSpacing: 1
-                color: textSecondary
+        sourceComponent: Dialog {
+            id: addTaskDialog
+            parent: Overlay.overlay
+            anchors.centerIn: parent
+            width: 500
+            modal: true
+
+            background: Rectangle {
+                color: bgMedium
+                radius: 20
+                border.width: 2
+                border.color: accentCyan
+
+                layer.enabled: true
+                layer.effect: MultiEffect {
+                    shadowEnabled: true
+                    shadowColor: Qt.rgba(0, 0.85, 1, 0.5)
+                    shadowBlur: 0.5
+                }
             }
 
-            TextField {
-                id: taskNameField
-                Layout.fillWidth: true
-                placeholderText: "Enter task name..."
-                font.pixelSize: 14
-                color: textPrimary
-
-                background: Rectangle {
-                    color: bgCard
-                    radius: 8
-                    border.width: 2
-                    border.color: parent.activeFocus ? accentCyan : Qt.rgba(1, 1, 1, 0.1)
+            header: Item {
+                height: 60
 
-                    Behavior on border.color { ColorAnimation { duration: 200 } }
+                Label {
+                    anchors.centerIn: parent
+                    text: "CREATE NEW TASK"
+                    font.pixelSize: 20
+                    font.bold: true
+                    font.letterSpacing: 2
+                    color: textPrimary
                 }
             }
 
-            Label {
-                text: "DESCRIPTION"
-                font.pixelSize: 12
-                font.bold: true
-                font.letterSpacing: 1
-                color: textSecondary
-            }
+            contentItem: ColumnLayout {
+                spacing: 20
 
-            ScrollView {
-                Layout.fillWidth: true
-                Layout.preferredHeight: 120
+                Label {
+                    text: "TASK NAME"
+                    font.pixelSize: 12
+                    font.bold: true
+                    font.letterSpacing: 1
+                    color: textSecondary
+                }
 
-                TextArea {
-                    id: taskDescField
-                    placeholderText: "Enter task description..."
+                TextField {
+                    id: taskNameField
+                    Layout.fillWidth: true
+                    placeholderText: "Enter task name..."
                     font.pixelSize: 14
                     color: textPrimary
-                    wrapMode: TextArea.Wrap
 
                     background: Rectangle {
                         color: bgCard
@@ -666,112 +751,142 @@ ApplicationWindow {
                         Behavior on border.color { ColorAnimation { duration: 200 } }
                     }
                 }
-            }
 
-            Label {
-                text: "PRIORITY"
-                font.pixelSize: 12
-                font.bold: true
-                font.letterSpacing: 1
-                color: textSecondary
-            }
+                Label {
+                    text: "DESCRIPTION"
+                    font.pixelSize: 12
+                    font.bold: true
+                    font.letterSpacing: 1
+                    color: textSecondary
+                }
 
-            ComboBox {
-                id: priorityCombo
-                Layout.fillWidth: true
-                model: ["🟢 Low", "🟡 Medium", "🔴 High"]
-                currentIndex: 1
-                font.pixelSize: 14
+                ScrollView {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 120
 
-                background: Rectangle {
-                    color: bgCard
-                    radius: 8
-                    border.width: 2
-                    border.color: Qt.rgba(1, 1, 1, 0.1)
-                }
+                    TextArea {
+                        id: taskDescField
+                        placeholderText: "Enter task description..."
+                        font.pixelSize: 14
+                        color: textPrimary
+                        wrapMode: TextArea.Wrap
 
-                contentItem: Text {
-                    text: priorityCombo.displayText
-                    font: priorityCombo.font
-                    color: textPrimary
-                    verticalAlignment: Text.AlignVCenter
-                    leftPadding: 15
+                        background: Rectangle {
+                            color: bgCard
+                            radius: 8
+                            border.width: 2
+                            border.color: parent.activeFocus ? accentCyan : Qt.rgba(1, 1, 1, 0.1)
+
+                            Behavior on border.color { ColorAnimation { duration: 200 } }
+                        }
+                    }
                 }
-            }
 
-            RowLayout {
-                Layout.fillWidth: true
-                Layout.topMargin: 10
-                spacing: 15
+                Label {
+                    text: "PRIORITY"
+                    font.pixelSize: 12
+                    font.bold: true
+                    font.letterSpacing: 1
+                    color: textSecondary
+                }
 
-                Button {
-                    text: "CANCEL"
+                ComboBox {
+                    id: priorityCombo
                     Layout.fillWidth: true
-                    Layout.preferredHeight: 50
+                    model: ["🟢 Low", "🟡 Medium", "🔴 High"]
+                    currentIndex: 1
                     font.pixelSize: 14
-                    font.bold: true
 
                     background: Rectangle {
                         color: bgCard
-                        radius: 10
+                        radius: 8
                         border.width: 2
-                        border.color: textSecondary
+                        border.color: Qt.rgba(1, 1, 1, 0.1)
                     }
 
                     contentItem: Text {
-                        text: parent.text
-                        font: parent.font
-                        color: textSecondary
-                        horizontalAlignment: Text.AlignHCenter
+                        text: priorityCombo.displayText
+                        font: priorityCombo.font
+                        color: textPrimary
                         verticalAlignment: Text.AlignVCenter
+                        leftPadding: 15
                     }
-
-                    onClicked: addTaskDialog.close()
                 }
 
-                Button {
-                    text: "CREATE TASK"
+                RowLayout {
                     Layout.fillWidth: true
-                    Layout.preferredHeight: 50
-                    font.pixelSize: 14
-                    font.bold: true
-
-                    background: Rectangle {
-                        color: accentCyan
-                        radius: 10
-                        opacity: parent.hovered ? 1 : 0.9
+                    Layout.topMargin: 10
+                    spacing: 15
+
+                    Button {
+                        text: "CANCEL"
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 50
+                        font.pixelSize: 14
+                        font.bold: true
 
-                        Behavior on opacity { NumberAnimation { duration: 200 } }
+                        background: Rectangle {
+                            color: bgCard
+                            radius: 10
+                            border.width: 2
+                            border.color: textSecondary
+                        }
 
-                        layer.enabled: true
-                        layer.effect: MultiEffect {
-                            shadowEnabled: true
-                            shadowColor: accentCyan
-                            shadowBlur: 0.5
+                        contentItem: Text {
+                            text: parent.text
+                            font: parent.font
+                            color: textSecondary
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
                         }
-                    }
 
-                    contentItem: Text {
-                        text: parent.text
-                        font: parent.font
-                        color: bgDark
-                        horizontalAlignment: Text.AlignHCenter
-                        verticalAlignment: Text.AlignVCenter
+                        onClicked: addTaskDialog.close()
                     }
 
-                    onClicked: {
-                        if (taskNameField.text.trim() !== "") {
-                            console.log("Adding task:", taskNameField.text)
-                            taskModel.addTask(
-                                taskNameField.text,
-                                taskDescField.text,
-                                priorityCombo.currentIndex
-                            )
-                            taskNameField.clear()
-                            taskDescField.clear()
-                            priorityCombo.currentIndex = 1
-                            addTaskDialog.close()
-                            addNotification.show()
+                    Button {
+                        text: "CREATE TASK"
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 50
+                        font.pixelSize: 14
+                        font.bold: true
+
+                        background: Rectangle {
+                            color: accentCyan
+                            radius: 10
+                            opacity: parent.hovered ? 1 : 0.9
+
+                            Behavior on opacity { NumberAnimation { duration: 200 } }
+
+                            layer.enabled: true
+                            layer.effect: MultiEffect {
+                                shadowEnabled: true
+                                shadowColor: accentCyan
+                                shadowBlur: 0.5
+                            }
+                        }
+
+                        contentItem: Text {
+                            text: parent.text
+                            font: parent.font
+                            color: bgDark
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+
+                        onClicked: {
+                            if (taskNameField.text.trim() !== "") {
+                                console.log("Adding task:", taskNameField.text)
+                                taskModel.addTask(
+                                    taskNameField.text,
+                                    taskDescField.text,
+                                    priorityCombo.currentIndex
+                                )
+                                taskNameField.clear()
+                                taskDescField.clear()
+                                priorityCombo.currentIndex = 1
+                                addTaskDialog.close()
+                                addNotification.show()
+                            }
                         }
                     }
                 }
@@ -790,14 +905,29 @@ ApplicationWindow {
         radius: 25
         color: bgCard
         border.width: 2
-        border.color: successGreen
+        border.color: failed ? dangerRed : successGreen
         opacity: 0
 
+        // Set when the user asks to save; background saves stay silent
+        property bool pending: false
+        property bool failed: false
+
         function show() {
             opacity = 1
             hideTimer.restart()
         }
 
+        Connections {
+            target: taskModel
+            function onSaveFinished(success) {
+                if (!saveNotification.pending)
+                    return
+                saveNotification.pending = false
+                saveNotification.failed = !success
+                saveNotification.show()
+            }
+        }
+
         Behavior on opacity { NumberAnimation { duration: 300 } }
 
         Timer {
@@ -808,156 +938,428 @@ ApplicationWindow {
 
         Label {
             anchors.centerIn: parent
-            text: "✓ Saved!"
+            text: saveNotification.failed ? "✗ Save failed" : "✓ Saved!"
             font.pixelSize: 16
             font.bold: true
-            color: successGreen
+            color: saveNotification.failed ? dangerRed : successGreen
         }
     }
 
-    // Delete confirmation dialog
-    Dialog {
-        id: deleteConfirmDialog
-        anchors.centerIn: parent
-        width: 400
-        modal: true
-
-        property int taskIdToDelete: 0
-        property string taskNameToDelete: ""
+    // Reminder notification
+    Rectangle {
+        id: reminderNotification
+        anchors.horizontalCenter: parent.horizontalCenter
+        anchors.top: parent.top
+        anchors.topMargin: 50
+        width: Math.min(reminderLabel.implicitWidth + 60, parent.width - 40)
+        height: 50
+        radius: 25
+        color: bgCard
+        border.width: 2
+        border.color: warningOrange
+        opacity: 0
 
-        background: Rectangle {
-            color: bgMedium
-            radius: 20
-            border.width: 2
-            border.color: dangerRed
+        property string taskName: ""
 
-            layer.enabled: true
-            layer.effect: MultiEffect {
-                shadowEnabled: true
-                shadowColor: Qt.rgba(1, 0.2, 0.4, 0.5)
-                shadowBlur: 0.5
+        Connections {
+            target: taskModel
+            function onReminderDue(taskId, taskName) {
+                reminderNotification.taskName = taskName
+                reminderNotification.opacity = 1
+                reminderHideTimer.restart()
             }
         }
 
-        header: Item {
-            height: 60
+        Behavior on opacity { NumberAnimation { duration: 300 } }
 
-            Label {
-                anchors.centerIn: parent
-                text: "⚠ DELETE TASK"
-                font.pixelSize: 20
-                font.bold: true
-                font.letterSpacing: 2
-                color: dangerRed
-            }
+        Timer {
+            id: reminderHideTimer
+            interval: 5000
+            onTriggered: reminderNotification.opacity = 0
         }
 
-        contentItem: ColumnLayout {
-            spacing: 20
+        Label {
+            id: reminderLabel
+            anchors.centerIn: parent
+            width: parent.width - 40
+            horizontalAlignment: Text.AlignHCenter
+            elide: Text.ElideRight
+            text: "🔔 " + reminderNotification.taskName
+            font.pixelSize: 16
+            font.bold: true
+            color: warningOrange
+        }
+    }
 
-            Label {
-                text: "Are you sure you want to delete this task?"
-                font.pixelSize: 15
-                color: textPrimary
-                wrapMode: Text.Wrap
-                Layout.fillWidth: true
-                horizontalAlignment: Text.AlignHCenter
+    // Hot-path counters (Ctrl+Shift+T). Recording is switched from the
+    // overlay, never by showing it, so a TASKMANAGER_TRACE run keeps going
+    Shortcut {
+        sequence: "Ctrl+Shift+T"
+        onActivated: traceOverlay.active = !traceOverlay.active
+    }
+
+    Loader {
+        id: traceOverlay
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.margins: 20
+        z: 100
+        active: false
+
+        sourceComponent: Rectangle {
+            width: 460
+            height: Math.min(traceList.contentHeight + 90, root.height - 40)
+            radius: 12
+            color: Qt.rgba(0.04, 0.05, 0.15, 0.92)
+            border.width: 1
+            border.color: accentCyan
+
+            TraceCounterModel {
+                id: traceCounters
+                active: true
             }
 
-            Rectangle {
-                Layout.fillWidth: true
-                Layout.preferredHeight: 60
-                color: bgCard
-                radius: 10
-                border.width: 1
-                border.color: dangerRed
+            ColumnLayout {
+                anchors.fill: parent
+                anchors.margins: 12
+                spacing: 6
+
+                RowLayout {
+                    Layout.fillWidth: true
+
+                    Label {
+                        text: "TRACE"
+                        font.bold: true
+                        font.letterSpacing: 1.5
+                        color: accentCyan
+                        Layout.fillWidth: true
+                    }
+
+                    Button {
+                        text: traceCounters.tracing ? "Stop" : "Record"
+                        flat: true
+                        onClicked: traceCounters.tracing = !traceCounters.tracing
+                    }
+
+                    Button {
+                        text: "Reset"
+                        flat: true
+                        onClicked: traceCounters.reset()
+                    }
+
+                    Button {
+                        text: "Save trace"
+                        flat: true
+                        onClicked: {
+                            var path = StandardPaths.writableLocation(StandardPaths.TempLocation) + "/taskmanager-trace.json"
+                            console.log(traceCounters.saveTrace(path) ? "Trace written to " + path : "Failed to write trace")
+                        }
+                    }
+                }
 
                 Label {
-                    anchors.centerIn: parent
-                    anchors.margins: 10
-                    text: '"' + deleteConfirmDialog.taskNameToDelete + '"'
-                    font.pixelSize: 14
-                    font.italic: true
+                    text: "span                                   calls     total ms   avg µs   max µs"
+                    font.family: "monospace"
+                    font.pixelSize: 11
                     color: textSecondary
-                    wrapMode: Text.Wrap
-                    width: parent.width - 20
-                    horizontalAlignment: Text.AlignHCenter
+                }
+
+                ListView {
+                    id: traceList
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    clip: true
+                    model: traceCounters
+
+                    delegate: Label {
+                        required property string name
+                        required property var calls
+                        required property double totalMs
+                        required property double averageUs
+                        required property double maxUs
+
+                        width: traceList.width
+                        font.family: "monospace"
+                        font.pixelSize: 11
+                        color: textPrimary
+                        text: name.padEnd(38) + String(calls).padStart(6)
+                              + totalMs.toFixed(1).padStart(12)
+                              + averageUs.toFixed(1).padStart(9)
+                              + maxUs.toFixed(0).padStart(9)
+                    }
                 }
             }
+        }
+    }
 
-            Label {
-                text: "This action cannot be undone."
-                font.pixelSize: 12
-                color: textSecondary
-                Layout.fillWidth: true
-                horizontalAlignment: Text.AlignHCenter
+    // Throughput (Ctrl+Shift+A); figures are only computed while shown
+    Shortcut {
+        sequence: "Ctrl+Shift+A"
+        onActivated: analyticsOverlay.active = !analyticsOverlay.active
+    }
+
+    Loader {
+        id: analyticsOverlay
+        anchors.top: parent.top
+        anchors.left: parent.left
+        anchors.margins: 20
+        z: 100
+        active: false
+
+        sourceComponent: Rectangle {
+            width: 420
+            height: Math.min(analyticsColumn.implicitHeight + 24, root.height - 40)
+            radius: 12
+            color: Qt.rgba(0.04, 0.05, 0.15, 0.92)
+            border.width: 1
+            border.color: successGreen
+
+            TaskAnalyticsModel {
+                id: analytics
+                sourceModel: taskModel
+                active: true
             }
 
-            RowLayout {
-                Layout.fillWidth: true
-                Layout.topMargin: 10
-                spacing: 15
+            ColumnLayout {
+                id: analyticsColumn
+                anchors.fill: parent
+                anchors.margins: 12
+                spacing: 6
 
-                Button {
-                    text: "CANCEL"
+                RowLayout {
                     Layout.fillWidth: true
-                    Layout.preferredHeight: 50
-                    font.pixelSize: 14
-                    font.bold: true
 
-                    background: Rectangle {
-                        color: bgCard
-                        radius: 10
-                        border.width: 2
-                        border.color: textSecondary
+                    Label {
+                        text: "THROUGHPUT"
+                        font.bold: true
+                        font.letterSpacing: 1.5
+                        color: successGreen
+                        Layout.fillWidth: true
                     }
 
-                    contentItem: Text {
-                        text: parent.text
-                        font: parent.font
-                        color: textSecondary
-                        horizontalAlignment: Text.AlignHCenter
-                        verticalAlignment: Text.AlignVCenter
+                    Button {
+                        text: analytics.weekly ? "Weekly" : "Daily"
+                        flat: true
+                        onClicked: analytics.weekly = !analytics.weekly
                     }
+                }
 
-                    onClicked: deleteConfirmDialog.close()
+                Label {
+                    text: analytics.completedCount + " completed · cycle time mean "
+                          + analytics.meanCycleHours.toFixed(1) + " h, median "
+                          + analytics.medianCycleHours.toFixed(1) + " h"
+                    font.pixelSize: 12
+                    color: textPrimary
                 }
 
-                Button {
-                    text: "DELETE"
-                    Layout.fillWidth: true
-                    Layout.preferredHeight: 50
-                    font.pixelSize: 14
-                    font.bold: true
+                Repeater {
+                    model: analytics.leadTimes
 
-                    background: Rectangle {
-                        color: dangerRed
-                        radius: 10
-                        opacity: parent.hovered ? 1 : 0.9
+                    delegate: Label {
+                        required property var modelData
 
-                        Behavior on opacity { NumberAnimation { duration: 200 } }
+                        font.family: "monospace"
+                        font.pixelSize: 11
+                        color: textSecondary
+                        text: taskModel.priorityToString(modelData.priority).padEnd(8)
+                              + String(modelData.count).padStart(6) + "  p50 "
+                              + modelData.p50Hours.toFixed(1).padStart(7) + " h  p90 "
+                              + modelData.p90Hours.toFixed(1).padStart(7) + " h  p95 "
+                              + modelData.p95Hours.toFixed(1).padStart(7) + " h"
+                    }
+                }
 
-                        layer.enabled: true
-                        layer.effect: MultiEffect {
-                            shadowEnabled: true
-                            shadowColor: dangerRed
-                            shadowBlur: 0.5
+                ListView {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: contentHeight
+                    Layout.maximumHeight: 360
+                    clip: true
+                    interactive: contentHeight > height
+                    model: analytics
+
+                    delegate: RowLayout {
+                        required property string label
+                        required property int count
+                        required property double fraction
+
+                        width: ListView.view.width
+                        spacing: 8
+
+                        Label {
+                            text: label
+                            font.pixelSize: 11
+                            color: textSecondary
+                            Layout.preferredWidth: 60
+                        }
+
+                        Rectangle {
+                            Layout.preferredWidth: Math.max(2, fraction * 260)
+                            Layout.preferredHeight: 8
+                            radius: 4
+                            color: successGreen
+                            opacity: count > 0 ? 0.9 : 0.2
+                        }
+
+                        Label {
+                            text: count
+                            font.pixelSize: 11
+                            color: textPrimary
                         }
                     }
+                }
+            }
+        }
+    }
 
-                    contentItem: Text {
-                        text: parent.text
-                        font: parent.font
-                        color: bgDark
+    // Delete confirmation dialog
+    Loader {
+        id: deleteConfirmDialogLoader
+        active: false
+
+        sourceComponent: Dialog {
+            id: deleteConfirmDialog
+            parent: Overlay.overlay
+            anchors.centerIn: parent
+            width: 400
+            modal: true
+
+            property double taskIdToDelete: 0
+            property string taskNameToDelete: ""
+
+            background: Rectangle {
+                color: bgMedium
+                radius: 20
+                border.width: 2
+                border.color: dangerRed
+
+                layer.enabled: true
+                layer.effect: MultiEffect {
+                    shadowEnabled: true
+                    shadowColor: Qt.rgba(1, 0.2, 0.4, 0.5)
+                    shadowBlur: 0.5
+                }
+            }
+
+            header: Item {
+                height: 60
+
+                Label {
+                    anchors.centerIn: parent
+                    text: "⚠ DELETE TASK"
+                    font.pixelSize: 20
+                    font.bold: true
+                    font.letterSpacing: 2
+                    color: dangerRed
+                }
+            }
+
+            contentItem: ColumnLayout {
+                spacing: 20
+
+                Label {
+                    text: "Are you sure you want to delete this task?"
+                    font.pixelSize: 15
+                    color: textPrimary
+                    wrapMode: Text.Wrap
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignHCenter
+                }
+
+                Rectangle {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 60
+                    color: bgCard
+                    radius: 10
+                    border.width: 1
+                    border.color: dangerRed
+
+                    Label {
+                        anchors.centerIn: parent
+                        anchors.margins: 10
+                        text: '"' + deleteConfirmDialog.taskNameToDelete + '"'
+                        font.pixelSize: 14
+                        font.italic: true
+                        color: textSecondary
+                        wrapMode: Text.Wrap
+                        width: parent.width - 20
                         horizontalAlignment: Text.AlignHCenter
-                        verticalAlignment: Text.AlignVCenter
                     }
+                }
 
-                    onClicked: {
-                        console.log("Deleting task ID:", deleteConfirmDialog.taskIdToDelete)
-                        taskModel.removeTask(deleteConfirmDialog.taskIdToDelete)
-                        deleteConfirmDialog.close()
-                        deleteNotification.show()
+                Label {
+                    text: "This action cannot be undone."
+                    font.pixelSize: 12
+                    color: textSecondary
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignHCenter
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.topMargin: 10
+                    spacing: 15
+
+                    Button {
+                        text: "CANCEL"
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 50
+                        font.pixelSize: 14
+                        font.bold: true
+
+                        background: Rectangle {
+                            color: bgCard
+                            radius: 10
+                            border.width: 2
+                            border.color: textSecondary
+                        }
+
+                        contentItem: Text {
+                            text: parent.text
+                            font: parent.font
+                            color: textSecondary
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+
+                        onClicked: deleteConfirmDialog.close()
+                    }
+
+                    Button {
+                        text: "DELETE"
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 50
+                        font.pixelSize: 14
+                        font.bold: true
+
+                        background: Rectangle {
+                            color: dangerRed
+                            radius: 10
+                            opacity: parent.hovered ? 1 : 0.9
+
+                            Behavior on opacity { NumberAnimation { duration: 200 } }
+
+                            layer.enabled: true
+                            layer.effect: MultiEffect {
+                                shadowEnabled: true
+                                shadowColor: dangerRed
+                                shadowBlur: 0.5
+                            }
+                        }
+
+                        contentItem: Text {
+                            text: parent.text
+                            font: parent.font
+                            color: bgDark
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+
+                        onClicked: {
+                            console.log("Deleting task ID:", deleteConfirmDialog.taskIdToDelete)
+                            taskModel.removeTask(deleteConfirmDialog.taskIdToDelete)
+                            deleteConfirmDialog.close()
+                            deleteNotification.show()
+                        }
                     }
                 }
             }
@@ -1035,7 +1437,8 @@ ApplicationWindow {
             color: accentCyan
         }
 
-        layer.enabled: true
+        // Only rendered through the effect while showing
+        layer.enabled: opacity > 0
         layer.effect: MultiEffect {
             shadowEnabled: true
             shadowColor: accentCyan
@@ -1093,7 +1496,7 @@ ApplicationWindow {
             }
         }
 
-        layer.enabled: true
+        layer.enabled: opacity > 0
         layer.effect: MultiEffect {
             shadowEnabled: true
             shadowColor: accentCyan
@@ -1101,25 +1504,6 @@ ApplicationWindow {
         }
     }
 
-    // Helper functions
-    function getActiveCount() {
-        var count = 0
-        for (var i = 0; i < taskModel.count; i++) {
-            var status = taskModel.data(taskModel.index(i, 0), 259) // TaskStatusRole
-            if (status === 0 || status === 1) count++
-        }
-        return count
-    }
-
-    function getCompletedCount() {
-        var count = 0
-        for (var i = 0; i < taskModel.count; i++) {
-            var completed = taskModel.data(taskModel.index(i, 0), 261) // TaskIsCompletedRole
-            if (completed) count++
-        }
-        return count
-    }
-
     // Custom components
     component StatCard: Rectangle {
         property string label: ""
@@ -1,47 +1,49 @@
 #include "Task.h"
 #include <QDataStream>
-#include <cstring>
 #include <QIODevice>
 
-Task::Task(uint8_t taskId,
+Task::Task()
+    : m_taskId(0),
+    m_taskStatus(TaskStatus::PENDING),
+    m_priority(TaskPriority::MEDIUM)
+{
+}
+
+Task::Task(TaskId taskId,
            const QString &taskName,
            const QString &taskDescription,
-           const TaskPriority &taskPriority,
-           QObject *parent)
-    : QObject(parent),
-    m_taskId(taskId),
+           const TaskPriority &taskPriority)
+    : m_taskId(taskId),
+    m_taskName(taskName),
+    m_taskDescription(taskDescription),
     m_taskStatus(TaskStatus::PENDING),
     m_priority(taskPriority),
     m_createdTime(QDateTime::currentDateTimeUtc()),
     m_completedTime({})
 {
-    setTaskName(taskName);
-    setTaskDescription(taskDescription);
 }
 
 // -------------------- Getters --------------------
-uint8_t Task::taskId() const { return m_taskId; }
-QString Task::taskName() const { return QString::fromUtf8(m_taskName); }
-QString Task::taskDescription() const { return QString::fromUtf8(m_taskDescription); }
+TaskId Task::taskId() const { return m_taskId; }
+QString Task::taskName() const { return m_taskName; }
+QString Task::taskDescription() const { return m_taskDescription; }
 TaskStatus Task::status() const { return m_taskStatus; }
 TaskPriority Task::priority() const { return m_priority; }
 bool Task::isCompleted() const { return m_taskStatus == COMPLETED; }
 QDateTime Task::createdTime() const { return m_createdTime; }
 QDateTime Task::completedTime() const { return m_completedTime; }
+QDateTime Task::dueTime() const { return m_dueTime; }
+QDateTime Task::reminderTime() const { return m_reminderTime; }
 
 // -------------------- Setters --------------------
 void Task::setTaskName(const QString &name)
 {
-    QByteArray bytes = name.left(32).toUtf8();
-    std::strncpy(m_taskName, bytes.constData(), sizeof(m_taskName) - 1);
-    m_taskName[sizeof(m_taskName)-1] = '\0';
+    m_taskName = name;
 }
 
 void Task::setTaskDescription(const QString &description)
 {
-    QByteArray bytes = description.left(255).toUtf8();
-    std::strncpy(m_taskDescription, bytes.constData(), sizeof(m_taskDescription) - 1);
-    m_taskDescription[sizeof(m_taskDescription)-1] = '\0';
+    m_taskDescription = description;
 }
 
 void Task::setStatus(TaskStatus status)
@@ -56,40 +58,43 @@ void Task::setPriority(TaskPriority p)
     m_priority = p;
 }
 
+void Task::setCreatedTime(const QDateTime &time)
+{
+    m_createdTime = time;
+}
+
+void Task::setCompletedTime(const QDateTime &time)
+{
+    m_completedTime = time;
+}
+
+void Task::setDueTime(const QDateTime &time)
+{
+    m_dueTime = time;
+}
+
+void Task::setReminderTime(const QDateTime &time)
+{
+    m_reminderTime = time;
+}
+
 // -------------------- Actions --------------------
 void Task::markCompleted()
 {
     if (m_taskStatus != COMPLETED) {
         m_taskStatus = COMPLETED;
         m_completedTime = QDateTime::currentDateTimeUtc();
-        emit taskCompleted(this);
     }
 }
 
 // -------------------- Serialization --------------------
-QByteArray Task::toByteArray() const
-{
-    QByteArray arr;
-    QDataStream out(&arr, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_6_5);
-
-    out << m_taskId;
-    out.writeRawData(m_taskName, sizeof(m_taskName));
-    out.writeRawData(m_taskDescription, sizeof(m_taskDescription));
-    out << static_cast<uint8_t>(m_taskStatus);
-    out << static_cast<uint8_t>(m_priority);
-    out << m_createdTime;
-    out << m_completedTime;
-
-    return arr;
-}
 
-Task* Task::fromByteArray(const QByteArray &data, QObject *parent)
+bool Task::fromByteArray(const QByteArray &data, quint16 version, Task &outTask)
 {
     QDataStream in(data);
     in.setVersion(QDataStream::Qt_6_5);
 
-    uint8_t id;
+    TaskId id;
     char name[33];
     char desc[256];
     uint8_t status;
@@ -97,7 +102,16 @@ Task* Task::fromByteArray(const QByteArray &data, QObject *parent)
     QDateTime created;
     QDateTime completed;
 
-    in >> id;
+    // Version 1 files stored the ID as a single byte
+    if (version < 2) {
+        uint8_t shortId;
+        in >> shortId;
+        id = shortId;
+    } else {
+        quint64 wideId;
+        in >> wideId;
+        id = wideId;
+    }
     in.readRawData(name, sizeof(name));
     in.readRawData(desc, sizeof(desc));
     in >> status;
@@ -105,13 +119,35 @@ Task* Task::fromByteArray(const QByteArray &data, QObject *parent)
     in >> created;
     in >> completed;
 
+    // Due and reminder times were appended later; older payloads end here
+    QDateTime due;
+    QDateTime reminder;
+    if (!in.atEnd())
+        in >> due >> reminder;
+
+    // So was the untruncated text
+    QString fullName;
+    QString fullDescription;
+    const bool fullText = !in.atEnd();
+    if (fullText)
+        in >> fullName >> fullDescription;
+
+    if (in.status() != QDataStream::Ok || status > COMPLETED || priority > HIGH)
+        return false;
+
+    // Both buffers were written NUL-terminated; guard against corrupt input
+    name[sizeof(name) - 1] = '\0';
+    desc[sizeof(desc) - 1] = '\0';
+
     TaskPriority pr = static_cast<TaskPriority>(priority);
 
-    Task *task = new Task(id, QString::fromUtf8(name), QString::fromUtf8(desc), pr, parent);
-    task->m_taskStatus = static_cast<TaskStatus>(status);
-    task->m_priority   = static_cast<TaskPriority>(priority);
-    task->m_createdTime = created;
-    task->m_completedTime = completed;
+    outTask = Task(id, fullText ? fullName : QString::fromUtf8(name),
+                   fullText ? fullDescription : QString::fromUtf8(desc), pr);
+    outTask.m_taskStatus = static_cast<TaskStatus>(status);
+    outTask.m_createdTime = created;
+    outTask.m_completedTime = completed;
+    outTask.m_dueTime = due;
+    outTask.m_reminderTime = reminder;
 
-    return task;
+    return true;
 }
@@ -1,7 +1,8 @@
 #ifndef TASK_H
 #define TASK_H
 
-#include <QObject>
+#include <QtGlobal>
+#include <QString>
 #include <QDateTime>
 #include <QByteArray>
 #include <cstdint>
@@ -19,18 +20,23 @@ enum TaskPriority : uint8_t {
     HIGH
 };
 
-class Task : public QObject
+// Task IDs come from a monotonic counter persisted by TaskStore and are never reused
+using TaskId = quint64;
+
+// Plain value type describing one task. TaskManager keeps its tasks in a
+// columnar TaskTable; Task is only used to move a single row in and out of
+// it (creation, serialization, inspection).
+class Task
 {
-    Q_OBJECT
 public:
-    explicit Task(uint8_t taskId,
+    Task();
+    explicit Task(TaskId taskId,
                   const QString &taskName,
                   const QString &taskDescription,
-                  const TaskPriority &taskPriority,
-                  QObject *parent = nullptr);
+                  const TaskPriority &taskPriority);
 
     // Getters
-    uint8_t taskId() const;
+    TaskId taskId() const;
     QString taskName() const;
     QString taskDescription() const;
     TaskStatus status() const;
@@ -38,33 +44,38 @@ public:
     bool isCompleted() const;
     QDateTime createdTime() const;
     QDateTime completedTime() const;
+    QDateTime dueTime() const;          // invalid when there is no due date
+    QDateTime reminderTime() const;     // invalid when there is no reminder
 
     // Setters
     void setTaskName(const QString &name);
     void setTaskDescription(const QString &description);
     void setStatus(TaskStatus status);
     void setPriority(TaskPriority p);
+    void setCreatedTime(const QDateTime &time);
+    void setCompletedTime(const QDateTime &time);
+    void setDueTime(const QDateTime &time);
+    void setReminderTime(const QDateTime &time);
 
     // Actions
     void markCompleted();
 
-    // Serialization
-    QByteArray toByteArray() const;
-    static Task* fromByteArray(const QByteArray &data, QObject *parent = nullptr);
-
-signals:
-    void taskCompleted(Task *task);
+    // Reads the per-task blob of v1/v2 snapshots and journals; nothing
+    // writes that layout any more
+    static bool fromByteArray(const QByteArray &data, quint16 version, Task &outTask);
 
 private:
-    uint8_t m_taskId;
-    char m_taskName[33];
-    char m_taskDescription[256];
+    TaskId m_taskId;
+    QString m_taskName;
+    QString m_taskDescription;
 
     TaskStatus m_taskStatus;
     TaskPriority m_priority;
 
     QDateTime m_createdTime;
     QDateTime m_completedTime;
+    QDateTime m_dueTime;
+    QDateTime m_reminderTime;
 };
 
 #endif // TASK_H
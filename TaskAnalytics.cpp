@@ -0,0 +1,166 @@
+#include "TaskAnalytics.h"
+#include <QDateTime>
+#include <algorithm>
+#include <QtConcurrent/QtConcurrentMap>
+#include "TaskTrace.h"
+
+static constexpr qint64 DAY_MS = 24 * 60 * 60 * 1000;
+static constexpr qint64 WEEK_MS = 7 * DAY_MS;
+
+// Below this a single pass beats handing slices to the thread pool
+static constexpr int PARALLEL_ROWS = 1 << 16;
+static constexpr int SLICE_ROWS = 1 << 15;
+
+namespace {
+
+// Histogram buckets count back from the end of the current day and week
+struct Window {
+    qint64 dayEnd;
+    qint64 weekEnd;
+    int days;
+    int weeks;
+};
+
+// What one slice of rows contributes
+struct Partial {
+    int completed = 0;
+    qint64 cycleSum = 0;
+    QVector<int> perDay;
+    QVector<int> perWeek;
+    QVector<qint64> cycles[HIGH + 1];
+};
+
+} // namespace
+
+static Partial reduceSlice(const TaskTable &tasks, int first, int last, const Window &window)
+{
+    const TaskStatus *status = tasks.statuses().constData();
+    const TaskPriority *priority = tasks.priorities().constData();
+    const qint64 *created = tasks.createdTimes().constData();
+    const qint64 *completed = tasks.completedTimes().constData();
+
+    Partial out;
+    out.perDay.resize(window.days);
+    out.perWeek.resize(window.weeks);
+
+    // Count and sum without branches over the raw columns, so the compiler
+    // can vectorize it. completedMs is left behind when a task is reopened,
+    // so status decides.
+    int count = 0;
+    qint64 sum = 0;
+    for (int i = first; i < last; ++i) {
+        const qint64 mask = -qint64(status[i] == COMPLETED);
+        count += int(mask & 1);
+        sum += qMax<qint64>(0, completed[i] - created[i]) & mask;
+    }
+    out.completed = count;
+    out.cycleSum = sum;
+    if (count == 0)
+        return out;
+
+    // Bucketing scatters, so it only visits completed rows. A completion
+    // dated after now counts toward the current day.
+    for (int p = LOW; p <= HIGH; ++p)
+        out.cycles[p].reserve(count / (HIGH + 1) + 1);
+    for (int i = first; i < last; ++i) {
+        if (status[i] != COMPLETED)
+            continue;
+        out.cycles[priority[i]].append(qMax<qint64>(0, completed[i] - created[i]));
+
+        const qint64 dayAgo = qMax<qint64>(0, window.dayEnd - 1 - completed[i]) / DAY_MS;
+        if (dayAgo < window.days)
+            ++out.perDay[int(dayAgo)];
+        const qint64 weekAgo = qMax<qint64>(0, window.weekEnd - 1 - completed[i]) / WEEK_MS;
+        if (weekAgo < window.weeks)
+            ++out.perWeek[int(weekAgo)];
+    }
+    return out;
+}
+
+static void merge(Partial &into, const Partial &from)
+{
+    into.completed += from.completed;
+    into.cycleSum += from.cycleSum;
+    for (int i = 0; i < into.perDay.size(); ++i)
+        into.perDay[i] += from.perDay.at(i);
+    for (int i = 0; i < into.perWeek.size(); ++i)
+        into.perWeek[i] += from.perWeek.at(i);
+    for (int p = LOW; p <= HIGH; ++p)
+        into.cycles[p] += from.cycles[p];
+}
+
+// Nearest-rank percentile; values is partly reordered, and elements before
+// from are already known to be no larger than the answer
+static qint64 percentile(QVector<qint64> &values, QVector<qint64>::iterator &from, int percent)
+{
+    const qint64 rank = (qint64(values.size()) * percent + 99) / 100;
+    const auto nth = values.begin() + qMax<qint64>(0, rank - 1);
+    std::nth_element(from, nth, values.end());
+    from = nth;
+    return *nth;
+}
+
+static TaskMetrics::Percentiles percentilesOf(QVector<qint64> &values)
+{
+    TaskMetrics::Percentiles out;
+    out.count = values.size();
+    if (values.isEmpty())
+        return out;
+
+    // Ascending, so each selection only searches past the previous one
+    auto from = values.begin();
+    out.p50Ms = percentile(values, from, 50);
+    out.p90Ms = percentile(values, from, 90);
+    out.p95Ms = percentile(values, from, 95);
+    return out;
+}
+
+TaskMetrics TaskAnalytics::compute(const TaskTable &tasks, qint64 nowMs, int days, int weeks)
+{
+    TASK_TRACE_SCOPE("TaskAnalytics::compute");
+    // Local calendar days and Monday-based weeks, stepped back in fixed
+    // 24-hour spans; a DST change shifts older boundaries by an hour
+    const QDate today = QDateTime::fromMSecsSinceEpoch(nowMs).date();
+    TaskMetrics metrics;
+    metrics.todayStartMs = today.startOfDay().toMSecsSinceEpoch();
+    metrics.weekStartMs = today.addDays(1 - today.dayOfWeek()).startOfDay().toMSecsSinceEpoch();
+    const Window window{metrics.todayStartMs + DAY_MS, metrics.weekStartMs + WEEK_MS,
+                        qMax(0, days), qMax(0, weeks)};
+
+    const int rows = tasks.size();
+    Partial total;
+    if (rows < PARALLEL_ROWS) {
+        total = reduceSlice(tasks, 0, rows, window);
+    } else {
+        QVector<QPair<int, int>> slices;
+        for (int first = 0; first < rows; first += SLICE_ROWS)
+            slices.append({first, qMin(rows, first + SLICE_ROWS)});
+
+        const QVector<Partial> partials = QtConcurrent::blockingMapped<QVector<Partial>>(
+            slices, [&tasks, &window](const QPair<int, int> &slice) {
+                return reduceSlice(tasks, slice.first, slice.second, window);
+            });
+        total = partials.first();
+        for (int i = 1; i < partials.size(); ++i)
+            merge(total, partials.at(i));
+    }
+
+    metrics.completed = total.completed;
+    metrics.perDay = total.perDay;
+    metrics.perWeek = total.perWeek;
+    if (total.completed == 0)
+        return metrics;
+
+    metrics.meanCycleMs = total.cycleSum / total.completed;
+
+    QVector<qint64> all;
+    all.reserve(total.completed);
+    for (int p = LOW; p <= HIGH; ++p)
+        all += total.cycles[p];
+    auto from = all.begin();
+    metrics.medianCycleMs = percentile(all, from, 50);
+
+    for (int p = LOW; p <= HIGH; ++p)
+        metrics.leadTime[p] = percentilesOf(total.cycles[p]);
+    return metrics;
+}
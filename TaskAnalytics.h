@@ -0,0 +1,41 @@
+#ifndef TASKANALYTICS_H
+#define TASKANALYTICS_H
+
+#include <QVector>
+#include "Task.h"
+#include "TaskTable.h"
+
+// Throughput figures for a board, computed straight from TaskTable's
+// epoch-ms columns. Cycle time is creation to completion, the only two
+// timestamps a task has, so it doubles as lead time.
+struct TaskMetrics {
+    struct Percentiles {
+        int count = 0;
+        qint64 p50Ms = 0;
+        qint64 p90Ms = 0;
+        qint64 p95Ms = 0;
+    };
+
+    int completed = 0;
+    qint64 meanCycleMs = 0;
+    qint64 medianCycleMs = 0;
+
+    // Completions per local calendar day / ISO week, [0] being the current
+    // one and [i] the one i back
+    QVector<int> perDay;
+    QVector<int> perWeek;
+    qint64 todayStartMs = 0;
+    qint64 weekStartMs = 0;
+
+    Percentiles leadTime[HIGH + 1];
+};
+
+class TaskAnalytics
+{
+public:
+    // Reads only the status, priority and timestamp columns. Boards past
+    // a few tens of thousands of rows are reduced in parallel slices.
+    static TaskMetrics compute(const TaskTable &tasks, qint64 nowMs, int days = 30, int weeks = 12);
+};
+
+#endif // TASKANALYTICS_H
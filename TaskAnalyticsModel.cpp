@@ -0,0 +1,175 @@
+#include "TaskAnalyticsModel.h"
+#include <QDateTime>
+#include <QLocale>
+#include <algorithm>
+#include "TaskListModel.h"
+
+TaskAnalyticsModel::TaskAnalyticsModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int TaskAnalyticsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_weekly ? Weeks : Days;
+}
+
+QVariant TaskAnalyticsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    const int row = index.row();
+    const QDate current = QDateTime::fromMSecsSinceEpoch(m_weekly ? metrics().weekStartMs
+                                                                  : metrics().todayStartMs).date();
+    const QDate start = current.addDays(-qint64(row) * (m_weekly ? 7 : 1));
+    switch (role) {
+    case LabelRole:
+        return QLocale().toString(start, m_weekly ? QStringLiteral("MMM d") : QStringLiteral("ddd d"));
+    case CountRole:
+        return buckets().value(row);
+    case StartTimeRole:
+        return start.startOfDay();
+    case FractionRole: {
+        const int max = maxCount();
+        return max > 0 ? double(buckets().value(row)) / max : 0.0;
+    }
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> TaskAnalyticsModel::roleNames() const
+{
+    return {
+        {LabelRole, "label"},
+        {CountRole, "count"},
+        {StartTimeRole, "startTime"},
+        {FractionRole, "fraction"}
+    };
+}
+
+void TaskAnalyticsModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (sourceModel == m_source)
+        return;
+
+    for (const QMetaObject::Connection &connection : std::as_const(m_sourceConnections))
+        disconnect(connection);
+    m_sourceConnections.clear();
+
+    m_source = sourceModel;
+    // statsChanged() follows every batch of changes the source applies
+    if (TaskListModel *tasks = qobject_cast<TaskListModel *>(sourceModel))
+        m_sourceConnections << connect(tasks, &TaskListModel::statsChanged, this, &TaskAnalyticsModel::invalidate);
+
+    m_stale = true;
+    if (m_active)
+        announce();
+    emit sourceModelChanged();
+}
+
+void TaskAnalyticsModel::setActive(bool active)
+{
+    if (active == m_active)
+        return;
+
+    m_active = active;
+    // Catch up on whatever changed while nobody was listening
+    if (active && m_stale)
+        announce();
+    emit activeChanged();
+}
+
+void TaskAnalyticsModel::setWeekly(bool weekly)
+{
+    if (weekly == m_weekly)
+        return;
+
+    beginResetModel();
+    m_weekly = weekly;
+    endResetModel();
+    emit weeklyChanged();
+}
+
+double TaskAnalyticsModel::meanCycleHours() const
+{
+    return double(metrics().meanCycleMs) / (60 * 60 * 1000);
+}
+
+double TaskAnalyticsModel::medianCycleHours() const
+{
+    return double(metrics().medianCycleMs) / (60 * 60 * 1000);
+}
+
+int TaskAnalyticsModel::maxCount() const
+{
+    const QVector<int> &counts = buckets();
+    return counts.isEmpty() ? 0 : *std::max_element(counts.cbegin(), counts.cend());
+}
+
+QVariantList TaskAnalyticsModel::leadTimes() const
+{
+    static constexpr double HOUR_MS = 60 * 60 * 1000;
+    QVariantList list;
+    for (int p = LOW; p <= HIGH; ++p) {
+        const TaskMetrics::Percentiles &lead = metrics().leadTime[p];
+        list.append(QVariantMap{
+            {QStringLiteral("priority"), p},
+            {QStringLiteral("count"), lead.count},
+            {QStringLiteral("p50Hours"), lead.p50Ms / HOUR_MS},
+            {QStringLiteral("p90Hours"), lead.p90Ms / HOUR_MS},
+            {QStringLiteral("p95Hours"), lead.p95Ms / HOUR_MS}
+        });
+    }
+    return list;
+}
+
+void TaskAnalyticsModel::refresh()
+{
+    m_stale = true;
+    announce();
+}
+
+const TaskMetrics &TaskAnalyticsModel::metrics() const
+{
+    if (m_stale) {
+        const TaskListModel *tasks = qobject_cast<const TaskListModel *>(m_source.data());
+        m_metrics = TaskAnalytics::compute(tasks ? tasks->tasks() : TaskTable(),
+                                           QDateTime::currentMSecsSinceEpoch(), Days, Weeks);
+        m_stale = false;
+    }
+    return m_metrics;
+}
+
+const QVector<int> &TaskAnalyticsModel::buckets() const
+{
+    return m_weekly ? metrics().perWeek : metrics().perDay;
+}
+
+void TaskAnalyticsModel::invalidate()
+{
+    // Still stale: nothing has read the figures since they were last
+    // announced, so there is no one to tell again
+    if (m_stale)
+        return;
+
+    m_stale = true;
+    // A burst of batches is announced once
+    if (m_active && !m_announceScheduled) {
+        m_announceScheduled = true;
+        QMetaObject::invokeMethod(this, &TaskAnalyticsModel::announce, Qt::QueuedConnection);
+    }
+}
+
+void TaskAnalyticsModel::announce()
+{
+    m_announceScheduled = false;
+    if (!m_active)
+        return;
+
+    // The bucket count never changes, only what is in them
+    emit dataChanged(index(0), index(rowCount() - 1));
+    emit metricsChanged();
+}
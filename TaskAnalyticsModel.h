@@ -0,0 +1,86 @@
+#ifndef TASKANALYTICSMODEL_H
+#define TASKANALYTICSMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QtQml/qqmlregistration.h>
+#include "TaskAnalytics.h"
+
+// Throughput of a TaskListModel: one row per day (or week, when `weekly`)
+// with the tasks completed in it, newest first, plus cycle-time figures
+// as properties. Computed from the source's copy of the table on first
+// read and cached until the source applies its next change; nothing is
+// announced while `active` is false.
+class TaskAnalyticsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(QAbstractItemModel *sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged)
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool weekly READ isWeekly WRITE setWeekly NOTIFY weeklyChanged)
+
+    Q_PROPERTY(int completedCount READ completedCount NOTIFY metricsChanged)
+    Q_PROPERTY(double meanCycleHours READ meanCycleHours NOTIFY metricsChanged)
+    Q_PROPERTY(double medianCycleHours READ medianCycleHours NOTIFY metricsChanged)
+    Q_PROPERTY(int maxCount READ maxCount NOTIFY metricsChanged)
+    // Per priority, low to high: {priority, count, p50Hours, p90Hours, p95Hours}
+    Q_PROPERTY(QVariantList leadTimes READ leadTimes NOTIFY metricsChanged)
+
+public:
+    enum Roles {
+        LabelRole = Qt::UserRole + 1,
+        CountRole,
+        StartTimeRole,
+        FractionRole        // count relative to the busiest bucket, for bars
+    };
+
+    explicit TaskAnalyticsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QAbstractItemModel *sourceModel() const { return m_source; }
+    void setSourceModel(QAbstractItemModel *sourceModel);
+
+    bool isActive() const { return m_active; }
+    void setActive(bool active);
+
+    bool isWeekly() const { return m_weekly; }
+    void setWeekly(bool weekly);
+
+    int completedCount() const { return metrics().completed; }
+    double meanCycleHours() const;
+    double medianCycleHours() const;
+    int maxCount() const;
+    QVariantList leadTimes() const;
+
+    // Recomputes now, e.g. after midnight moved the buckets
+    Q_INVOKABLE void refresh();
+
+signals:
+    void sourceModelChanged();
+    void activeChanged();
+    void weeklyChanged();
+    void metricsChanged();
+
+private:
+    static constexpr int Days = 30;
+    static constexpr int Weeks = 12;
+
+    QPointer<QAbstractItemModel> m_source;
+    QList<QMetaObject::Connection> m_sourceConnections;
+    bool m_active = true;
+    bool m_weekly = false;
+    bool m_announceScheduled = false;
+
+    mutable TaskMetrics m_metrics;
+    mutable bool m_stale = true;
+    const TaskMetrics &metrics() const;
+    const QVector<int> &buckets() const;
+
+    void invalidate();
+    void announce();
+};
+
+#endif // TASKANALYTICSMODEL_H
@@ -0,0 +1,322 @@
+#include "TaskEngine.h"
+#include "TaskLogging.h"
+#include "TaskTrace.h"
+
+TaskEngine::TaskEngine(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_manager(new TaskManager(filePath))
+{
+    m_thread.setObjectName(QStringLiteral("TaskEngine"));
+    m_manager->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_manager, &QObject::deleteLater);
+
+    // These run on the worker thread, straight after each mutation, and
+    // copy out the rows it touched while they are still where it left them
+    TaskManager *manager = m_manager;
+    connect(manager, &TaskManager::taskAdded, manager, [this](int row) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Insert;
+        diff.row = row;
+        diff.rows.append(m_manager->tasks(), row, 1);
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::taskRemoved, manager, [this](TaskId id) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Remove;
+        diff.id = id;
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::tasksRemoved, manager, [this](const QVector<int> &rows) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::RemoveRows;
+        diff.order = rows;
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::taskMoved, manager, [this](int from, int to) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Move;
+        diff.row = from;
+        diff.last = to;
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::tasksReordered, manager, [this](const QVector<int> &order) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Reorder;
+        diff.order = order;
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::taskChanged, manager, [this](int row, TaskManager::ChangedFields fields) {
+        recordChange({row}, fields);
+    });
+    connect(manager, &TaskManager::tasksChanged, manager,
+            [this](const QVector<TaskId> &ids, TaskManager::ChangedFields fields) {
+                QVector<int> rows;
+                rows.reserve(ids.size());
+                for (TaskId id : ids) {
+                    const int row = m_manager->indexOfTask(id);
+                    if (row >= 0)
+                        rows.append(row);
+                }
+                recordChange(rows, fields);
+            });
+    connect(manager, &TaskManager::tasksAppended, manager, [this](int first, int last) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Append;
+        // A load batch whose text stayed in the adopted pool hands it on, so
+        // the GUI copy shares it as well. Nothing is interned into it while
+        // the load lasts. Any other append copies only its own rows' text,
+        // leaving the worker's pool unshared.
+        if (m_manager->isLoading() && m_manager->lastBatchPooled())
+            diff.rows.adoptStrings(m_manager->tasks().strings());
+        diff.rows.append(m_manager->tasks(), first, last - first + 1);
+        record(std::move(diff));
+    });
+    connect(manager, &TaskManager::tasksReset, manager, [this]() {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Reset;
+        diff.rows = m_manager->tasks();
+        record(std::move(diff));
+    });
+
+    connect(manager, &TaskManager::saveFinished, manager, [this](bool success) {
+        deliver([this, success]() { emit saveFinished(success); });
+    });
+    connect(manager, &TaskManager::reminderDue, manager, [this](TaskId id) {
+        deliver([this, id]() { emit reminderDue(id); });
+    });
+    connect(manager, &TaskManager::dependencyRejected, manager, [this](TaskId taskId, TaskId blockerId) {
+        deliver([this, taskId, blockerId]() { emit dependencyRejected(taskId, blockerId); });
+    });
+    connect(manager, &TaskManager::dependenciesChanged, manager, [this]() {
+        // Completing a run of tasks asks once, after the last of them
+        if (!m_pathScheduled) {
+            m_pathScheduled = true;
+            QMetaObject::invokeMethod(m_manager, [this]() { updateCriticalPath(); }, Qt::QueuedConnection);
+        }
+    });
+    connect(manager, &TaskManager::loadProgress, manager, [this](int loaded, int total) {
+        deliver([this, loaded, total]() { emit loadProgress(loaded, total); });
+    });
+    connect(manager, &TaskManager::loadingChanged, manager, [this]() {
+        const bool loading = m_manager->isLoading();
+        deliver([this, loading]() {
+            m_loading = loading;
+            emit loadingChanged();
+        });
+    });
+
+    m_thread.start();
+}
+
+TaskEngine::~TaskEngine()
+{
+    // Queued behind the commands still pending, so they all run first; the
+    // manager is then deleted on its own thread
+    QThread *thread = &m_thread;
+    QMetaObject::invokeMethod(m_manager, [thread]() { thread->quit(); }, Qt::QueuedConnection);
+    m_thread.wait();
+}
+
+void TaskEngine::post(std::function<void(TaskManager &)> command)
+{
+    TaskManager *manager = m_manager;
+    QMetaObject::invokeMethod(manager, [manager, command]() { command(*manager); }, Qt::QueuedConnection);
+}
+
+void TaskEngine::addTask(const QString &name, const QString &desc, TaskPriority prio)
+{
+    post([name, desc, prio](TaskManager &manager) { manager.addTask(name, desc, prio); });
+}
+
+void TaskEngine::addTasks(const QVector<TaskManager::NewTask> &tasks)
+{
+    post([tasks](TaskManager &manager) { manager.addTasks(tasks); });
+}
+
+void TaskEngine::removeTask(TaskId id)
+{
+    post([id](TaskManager &manager) { manager.removeTask(id); });
+}
+
+void TaskEngine::removeTasks(const QVector<TaskId> &ids)
+{
+    post([ids](TaskManager &manager) { manager.removeTasks(ids); });
+}
+
+void TaskEngine::completeTask(TaskId id)
+{
+    post([id](TaskManager &manager) { manager.completeTask(id); });
+}
+
+void TaskEngine::doTask(TaskId id)
+{
+    post([id](TaskManager &manager) { manager.doTask(id); });
+}
+
+void TaskEngine::resetTask(TaskId id)
+{
+    post([id](TaskManager &manager) {
+        if (!manager.resetTask(id))
+            qCDebug(lcTaskManager) << "resetTask: Task with ID" << id << "not found";
+    });
+}
+
+void TaskEngine::setStatus(const QVector<TaskId> &ids, TaskStatus status)
+{
+    post([ids, status](TaskManager &manager) { manager.setStatus(ids, status); });
+}
+
+void TaskEngine::setPriority(const QVector<TaskId> &ids, TaskPriority priority)
+{
+    post([ids, priority](TaskManager &manager) { manager.setPriority(ids, priority); });
+}
+
+void TaskEngine::editTask(TaskId id, const QString &name, const QString &desc)
+{
+    post([id, name, desc](TaskManager &manager) { manager.editTask(id, name, desc); });
+}
+
+void TaskEngine::setSchedule(TaskId id, qint64 dueMs, qint64 reminderMs)
+{
+    post([id, dueMs, reminderMs](TaskManager &manager) { manager.setSchedule(id, dueMs, reminderMs); });
+}
+
+void TaskEngine::addDependency(TaskId taskId, TaskId blockerId)
+{
+    post([taskId, blockerId](TaskManager &manager) { manager.addDependency(taskId, blockerId); });
+}
+
+void TaskEngine::removeDependency(TaskId taskId, TaskId blockerId)
+{
+    post([taskId, blockerId](TaskManager &manager) { manager.removeDependency(taskId, blockerId); });
+}
+
+void TaskEngine::setSortOrder(const QVector<TaskManager::SortKey> &keys)
+{
+    post([keys](TaskManager &manager) { manager.setSortOrder(keys); });
+}
+
+void TaskEngine::sortByPriority(bool ascending)
+{
+    post([ascending](TaskManager &manager) { manager.sortByPriority(ascending); });
+}
+
+void TaskEngine::search(const QString &query)
+{
+    post([this, query](TaskManager &manager) {
+        const QVector<TaskId> ids = manager.search(query);
+        deliver([this, query, ids]() { emit searchFinished(query, ids); });
+    });
+}
+
+void TaskEngine::load()
+{
+    post([](TaskManager &manager) { manager.load(); });
+}
+
+void TaskEngine::loadAsync()
+{
+    post([](TaskManager &manager) { manager.loadAsync(); });
+}
+
+void TaskEngine::saveAsync()
+{
+    post([](TaskManager &manager) { manager.saveAsync(); });
+}
+
+void TaskEngine::setJournalEnabled(bool enabled)
+{
+    post([enabled](TaskManager &manager) { manager.setJournalEnabled(enabled); });
+}
+
+void TaskEngine::setLiveSyncEnabled(bool enabled)
+{
+    post([enabled](TaskManager &manager) { manager.setLiveSyncEnabled(enabled); });
+}
+
+void TaskEngine::setCompressionEnabled(bool enabled)
+{
+    post([enabled](TaskManager &manager) { manager.setCompressionEnabled(enabled); });
+}
+
+void TaskEngine::requestSnapshot()
+{
+    post([this](TaskManager &manager) {
+        TaskDiff diff;
+        diff.kind = TaskDiff::Reset;
+        diff.rows = manager.tasks();
+        record(std::move(diff));
+    });
+}
+
+void TaskEngine::record(TaskDiff diff)
+{
+    m_pending.append(std::move(diff));
+
+    // Everything a command (or a burst of them) changes goes out together
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(m_manager, [this]() { flush(); }, Qt::QueuedConnection);
+    }
+}
+
+void TaskEngine::recordChange(const QVector<int> &rows, TaskManager::ChangedFields fields)
+{
+    if (rows.isEmpty())
+        return;
+
+    const TaskTable &tasks = m_manager->tasks();
+    TaskDiff diff;
+    diff.kind = TaskDiff::Change;
+    diff.fields = fields;
+    diff.rows.reserve(rows.size());
+
+    // Text is copied only when it is what changed
+    const bool name = fields & TaskManager::NameField;
+    const bool description = fields & TaskManager::DescriptionField;
+    for (int row : rows) {
+        const int added = diff.rows.append(tasks.id(row), tasks.status(row), tasks.priority(row),
+                                           tasks.createdMs(row), tasks.completedMs(row),
+                                           name ? tasks.name(row) : QString(),
+                                           description ? tasks.description(row) : QString(),
+                                           tasks.dueMs(row), tasks.reminderMs(row));
+        if (tasks.isBlocked(row))
+            diff.rows.setBlocked(added, true);
+    }
+    record(std::move(diff));
+}
+
+void TaskEngine::flush()
+{
+    TASK_TRACE_SCOPE("TaskEngine::flush");
+    m_flushScheduled = false;
+    if (m_pending.isEmpty())
+        return;
+
+    TaskDiffBatch batch;
+    batch.fromVersion = m_version;
+    m_version += m_pending.size();
+    batch.toVersion = m_version;
+    batch.diffs.swap(m_pending);
+
+    QMetaObject::invokeMethod(this, [this, batch]() { emit diffsReady(batch); }, Qt::QueuedConnection);
+}
+
+void TaskEngine::updateCriticalPath()
+{
+    TASK_TRACE_SCOPE("TaskEngine::updateCriticalPath");
+    m_pathScheduled = false;
+    QVector<TaskId> path = m_manager->criticalPath();
+    if (path == m_criticalPath)
+        return;
+
+    m_criticalPath = path;
+    deliver([this, path]() { emit criticalPathChanged(path); });
+}
+
+void TaskEngine::deliver(std::function<void()> fn)
+{
+    // Anything reported after a change must not overtake it
+    flush();
+    QMetaObject::invokeMethod(this, fn, Qt::QueuedConnection);
+}
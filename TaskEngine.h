@@ -0,0 +1,121 @@
+#ifndef TASKENGINE_H
+#define TASKENGINE_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <functional>
+#include "TaskManager.h"
+
+// One change to the task table, as replayed on a copy of it. Rows carry
+// the task data the receiver needs, so it never reads the worker's table.
+struct TaskDiff {
+    enum Kind {
+        Insert,         // rows (one row) inserted at row
+        Remove,         // the task id removed, wherever it is
+        RemoveRows,     // rows order[] (ascending, numbered as before) removed
+        Move,           // row row moved to last
+        Change,         // fields of every task in rows changed
+        Reorder,        // new row i is old row order[i]
+        Append,         // rows appended at the end
+        Reset           // rows is the whole table
+    };
+
+    Kind kind = Reset;
+    int row = -1;
+    int last = -1;
+    TaskId id = 0;
+    TaskManager::ChangedFields fields;
+    QVector<int> order;
+    TaskTable rows;         // implicitly shared, so a Reset is cheap to send
+};
+
+// Diffs produced during one turn of the worker's event loop. Every diff
+// advances the engine's version by one, so a batch takes a receiver at
+// fromVersion to toVersion; one that starts elsewhere missed something
+// and asks for a Reset through requestSnapshot().
+struct TaskDiffBatch {
+    quint64 fromVersion = 0;
+    quint64 toVersion = 0;
+    QVector<TaskDiff> diffs;
+};
+
+// Runs a TaskManager on a worker thread that owns the task data. The GUI
+// posts commands, which return at once, and gets the resulting changes
+// back as diffsReady() batches to apply to its own copy of the table, so
+// loading, saving, sorting and searching never block rendering.
+//
+// Commands run in the order they were posted.
+class TaskEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TaskEngine(const QString &filePath, QObject *parent = nullptr);
+    ~TaskEngine();
+
+    void addTask(const QString &name, const QString &desc, TaskPriority prio = MEDIUM);
+    void addTasks(const QVector<TaskManager::NewTask> &tasks);
+    void removeTask(TaskId id);
+    void removeTasks(const QVector<TaskId> &ids);
+    void completeTask(TaskId id);
+    void doTask(TaskId id);
+    void resetTask(TaskId id);
+    void setStatus(const QVector<TaskId> &ids, TaskStatus status);
+    void setPriority(const QVector<TaskId> &ids, TaskPriority priority);
+    void editTask(TaskId id, const QString &name, const QString &desc);
+    void setSchedule(TaskId id, qint64 dueMs, qint64 reminderMs);
+    void addDependency(TaskId taskId, TaskId blockerId);
+    void removeDependency(TaskId taskId, TaskId blockerId);
+    void setSortOrder(const QVector<TaskManager::SortKey> &keys);
+    void sortByPriority(bool ascending);
+
+    // Results arrive through searchFinished()
+    void search(const QString &query);
+
+    void load();
+    void loadAsync();
+    void saveAsync();
+    bool isLoading() const { return m_loading; }
+
+    void setJournalEnabled(bool enabled);
+    void setLiveSyncEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+
+    // Sends the whole table as a Reset diff
+    void requestSnapshot();
+
+signals:
+    void diffsReady(const TaskDiffBatch &batch);
+    void searchFinished(const QString &query, const QVector<TaskId> &taskIds);
+    void reminderDue(TaskId taskId);
+    void dependencyRejected(TaskId taskId, TaskId blockerId);
+    // Recomputed once per burst of dependency changes, sent when it differs
+    void criticalPathChanged(const QVector<TaskId> &taskIds);
+
+    void saveFinished(bool success);
+    void loadProgress(int loaded, int total);
+    void loadingChanged();
+
+private:
+    QThread m_thread;
+    TaskManager *m_manager;     // lives on m_thread
+    bool m_loading = false;     // GUI-side copy of m_manager->isLoading()
+
+    // Worker thread only
+    QVector<TaskDiff> m_pending;
+    quint64 m_version = 0;
+    bool m_flushScheduled = false;
+    QVector<TaskId> m_criticalPath;
+    bool m_pathScheduled = false;
+
+    void post(std::function<void(TaskManager &)> command);
+    void record(TaskDiff diff);
+    void recordChange(const QVector<int> &rows, TaskManager::ChangedFields fields);
+    void flush();
+    void updateCriticalPath();
+    // Queues fn on the GUI thread, after every batch flushed so far
+    void deliver(std::function<void()> fn);
+};
+
+#endif // TASKENGINE_H
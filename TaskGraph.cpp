@@ -0,0 +1,570 @@
+#include "TaskGraph.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "TaskLogging.h"
+#include "TaskTrace.h"
+
+// The rows are rebuilt once overflow edges and tombstones reach a quarter
+// of all edges, and never for fewer changes than this
+static constexpr int REBUILD_MIN_CHANGES = 1024;
+
+template <typename F>
+void TaskGraph::forEachSuccessor(int node, F &&f) const
+{
+    if (node < m_builtNodes) {
+        for (int i = m_outStart[node]; i < m_outStart[node + 1]; ++i) {
+            if (m_dead.isEmpty() || !m_dead.contains(edgeKey(node, m_out[i])))
+                f(m_out[i]);
+        }
+    }
+    const auto it = m_outExtra.constFind(node);
+    if (it != m_outExtra.cend()) {
+        for (int next : *it)
+            f(next);
+    }
+}
+
+template <typename F>
+void TaskGraph::forEachPredecessor(int node, F &&f) const
+{
+    if (node < m_builtNodes) {
+        for (int i = m_inStart[node]; i < m_inStart[node + 1]; ++i) {
+            if (m_dead.isEmpty() || !m_dead.contains(edgeKey(m_in[i], node)))
+                f(m_in[i]);
+        }
+    }
+    const auto it = m_inExtra.constFind(node);
+    if (it != m_inExtra.cend()) {
+        for (int prev : *it)
+            f(prev);
+    }
+}
+
+void TaskGraph::clear()
+{
+    *this = TaskGraph();
+}
+
+void TaskGraph::reset(const QVector<TaskDependency> &dependencies, const TaskTable &tasks)
+{
+    TASK_TRACE_SCOPE("TaskGraph::reset");
+    QVector<TaskId> ids;
+    QVector<bool> done;
+    QHash<TaskId, int> nodeOf;
+    auto nodeOfTask = [&](TaskId id) {
+        const auto it = nodeOf.constFind(id);
+        if (it != nodeOf.cend())
+            return *it;
+        ids.append(id);
+        done.append(tasks.status(tasks.rowOf(id)) == COMPLETED);
+        return *nodeOf.insert(id, int(ids.size()) - 1);
+    };
+
+    QVector<QPair<int, int>> edges;
+    edges.reserve(dependencies.size());
+    int dropped = 0;
+    for (const TaskDependency &dependency : dependencies) {
+        if (dependency.blocker == dependency.blocked
+            || !tasks.contains(dependency.blocker) || !tasks.contains(dependency.blocked)) {
+            ++dropped;
+            continue;
+        }
+        const int from = nodeOfTask(dependency.blocker);
+        const int to = nodeOfTask(dependency.blocked);
+        edges.append({from, to});
+    }
+    if (dropped > 0)
+        qCDebug(lcTaskGraph) << "TaskGraph: Dropped" << dropped << "dependencies on missing tasks";
+
+    build(ids, done, std::move(edges));
+}
+
+void TaskGraph::build(const QVector<TaskId> &ids, const QVector<bool> &done, QVector<QPair<int, int>> edges)
+{
+    TASK_TRACE_SCOPE("TaskGraph::build");
+    const int n = int(ids.size());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Sorted by source, the edges already are the successor rows; the
+    // predecessor rows are filled through one cursor per target
+    QVector<int> outStart(n + 1, 0);
+    QVector<int> inStart(n + 1, 0);
+    for (const auto &edge : std::as_const(edges)) {
+        ++outStart[edge.first + 1];
+        ++inStart[edge.second + 1];
+    }
+    std::partial_sum(outStart.begin(), outStart.end(), outStart.begin());
+    std::partial_sum(inStart.begin(), inStart.end(), inStart.begin());
+
+    QVector<int> out(edges.size());
+    QVector<int> in(edges.size());
+    QVector<int> cursor = inStart;
+    for (int i = 0; i < edges.size(); ++i) {
+        out[i] = edges[i].second;
+        in[cursor[edges[i].second]++] = edges[i].first;
+    }
+
+    // Kahn's algorithm for the initial topological order
+    QVector<int> indegree(n);
+    QVector<int> order;
+    order.reserve(n);
+    for (int node = 0; node < n; ++node) {
+        indegree[node] = inStart[node + 1] - inStart[node];
+        if (indegree[node] == 0)
+            order.append(node);
+    }
+    for (int i = 0; i < order.size(); ++i) {
+        const int node = order[i];
+        for (int k = outStart[node]; k < outStart[node + 1]; ++k) {
+            if (--indegree[out[k]] == 0)
+                order.append(out[k]);
+        }
+    }
+
+    if (order.size() < n) {
+        // The nodes left over sit on or behind a cycle; edges between two of
+        // them go, which leaves the rest acyclic
+        QVector<bool> sorted(n, false);
+        for (int node : std::as_const(order))
+            sorted[node] = true;
+        const qsizetype before = edges.size();
+        edges.removeIf([&sorted](const QPair<int, int> &edge) {
+            return !sorted[edge.first] && !sorted[edge.second];
+        });
+        qCWarning(lcTaskGraph) << "TaskGraph: Dropped" << before - edges.size()
+                               << "dependencies that formed a cycle";
+        build(ids, done, std::move(edges));
+        return;
+    }
+
+    m_ids = ids;
+    m_nodeOf.clear();
+    m_nodeOf.reserve(n);
+    for (int node = 0; node < n; ++node)
+        m_nodeOf.insert(ids[node], node);
+
+    m_builtNodes = n;
+    m_outStart = outStart;
+    m_out = out;
+    m_inStart = inStart;
+    m_in = in;
+    m_outExtra.clear();
+    m_inExtra.clear();
+    m_dead.clear();
+    m_extraEdges = 0;
+    m_edges = int(edges.size());
+
+    m_nodeAt = order;
+    m_ord.resize(n);
+    for (int i = 0; i < n; ++i)
+        m_ord[order[i]] = i;
+
+    m_done = done;
+    m_open.fill(0, n);
+    m_depth.fill(0, n);
+    m_depthCount.clear();
+    m_mark.fill(false, n);
+    for (const auto &edge : std::as_const(edges)) {
+        if (!done[edge.first])
+            ++m_open[edge.second];
+    }
+
+    // In topological order every predecessor's depth is final
+    for (int node : std::as_const(order)) {
+        if (done[node])
+            continue;
+        int longest = 0;
+        for (int k = inStart[node]; k < inStart[node + 1]; ++k)
+            longest = qMax(longest, m_depth[in[k]]);
+        setDepth(node, longest + 1);
+    }
+}
+
+void TaskGraph::rebuildIfNeeded()
+{
+    if (m_extraEdges + m_dead.size() < qMax(REBUILD_MIN_CHANGES, m_edges / 4))
+        return;
+
+    // Nodes left without edges (unlinked or removed tasks) are dropped
+    const int n = int(m_ids.size());
+    QVector<int> newNode(n, -1);
+    QVector<TaskId> ids;
+    QVector<bool> done;
+    auto renumber = [&](int node) {
+        if (newNode[node] < 0) {
+            newNode[node] = int(ids.size());
+            ids.append(m_ids[node]);
+            done.append(m_done[node]);
+        }
+        return newNode[node];
+    };
+
+    QVector<QPair<int, int>> edges;
+    edges.reserve(m_edges);
+    for (int node = 0; node < n; ++node)
+        forEachSuccessor(node, [&](int next) { edges.append({node, next}); });
+    for (auto &edge : edges) {
+        edge.first = renumber(edge.first);
+        edge.second = renumber(edge.second);
+    }
+
+    build(ids, done, std::move(edges));
+}
+
+int TaskGraph::nodeFor(TaskId id, const TaskTable &tasks)
+{
+    const auto it = m_nodeOf.constFind(id);
+    if (it != m_nodeOf.cend())
+        return *it;
+
+    // Without edges it can go anywhere in the order; the end is free
+    const int node = int(m_ids.size());
+    const bool done = tasks.status(tasks.rowOf(id)) == COMPLETED;
+    m_ids.append(id);
+    m_nodeOf.insert(id, node);
+    m_ord.append(int(m_nodeAt.size()));
+    m_nodeAt.append(node);
+    m_done.append(done);
+    m_open.append(0);
+    m_depth.append(0);
+    m_mark.append(false);
+    if (!done)
+        setDepth(node, 1);
+    return node;
+}
+
+bool TaskGraph::inRows(int from, int to) const
+{
+    if (from >= m_builtNodes)
+        return false;
+    const int *begin = m_out.constData() + m_outStart[from];
+    const int *end = m_out.constData() + m_outStart[from + 1];
+    return std::binary_search(begin, end, to);
+}
+
+bool TaskGraph::hasEdge(int from, int to) const
+{
+    if (inRows(from, to))
+        return !m_dead.contains(edgeKey(from, to));
+    const auto it = m_outExtra.constFind(from);
+    return it != m_outExtra.cend() && it->contains(to);
+}
+
+TaskGraph::LinkResult TaskGraph::link(TaskId blocker, TaskId blocked, const TaskTable &tasks,
+                                      QVector<TaskId> &flipped)
+{
+    TASK_TRACE_SCOPE("TaskGraph::link");
+    if (blocker == blocked)
+        return WouldCycle;
+
+    // A new node has no edges yet, so it cannot be part of a cycle
+    const int from = nodeFor(blocker, tasks);
+    const int to = nodeFor(blocked, tasks);
+    if (hasEdge(from, to))
+        return AlreadyLinked;
+    if (m_ord[from] > m_ord[to] && !reorder(from, to))
+        return WouldCycle;
+
+    if (inRows(from, to)) {
+        m_dead.remove(edgeKey(from, to));
+    } else {
+        m_outExtra[from].append(to);
+        m_inExtra[to].append(from);
+        ++m_extraEdges;
+    }
+    ++m_edges;
+
+    if (!m_done[from]) {
+        const bool wasBlocked = blockedNode(to);
+        ++m_open[to];
+        if (!wasBlocked && blockedNode(to))
+            flipped.append(blocked);
+    }
+    propagateDepth(to);
+    rebuildIfNeeded();
+    return Linked;
+}
+
+bool TaskGraph::reorder(int from, int to)
+{
+    // The edge from -> to runs against the order. Only nodes positioned
+    // between the two can be affected: those reachable from `to` move
+    // after those that reach `from`, each group keeping its own order.
+    const int lower = m_ord[to];
+    const int upper = m_ord[from];
+
+    QVector<int> forward;
+    QVector<int> backward;
+    QVector<int> stack;
+
+    bool cycle = false;
+    m_mark[to] = true;
+    stack.append(to);
+    while (!stack.isEmpty() && !cycle) {
+        const int node = stack.takeLast();
+        forward.append(node);
+        forEachSuccessor(node, [&](int next) {
+            if (next == from)
+                cycle = true;
+            else if (!m_mark[next] && m_ord[next] < upper) {
+                m_mark[next] = true;
+                stack.append(next);
+            }
+        });
+    }
+    if (cycle) {
+        for (int node : std::as_const(forward))
+            m_mark[node] = false;
+        for (int node : std::as_const(stack))
+            m_mark[node] = false;
+        return false;
+    }
+
+    m_mark[from] = true;
+    stack.append(from);
+    while (!stack.isEmpty()) {
+        const int node = stack.takeLast();
+        backward.append(node);
+        forEachPredecessor(node, [&](int prev) {
+            if (!m_mark[prev] && m_ord[prev] > lower) {
+                m_mark[prev] = true;
+                stack.append(prev);
+            }
+        });
+    }
+    for (int node : std::as_const(forward))
+        m_mark[node] = false;
+    for (int node : std::as_const(backward))
+        m_mark[node] = false;
+
+    const auto byOrder = [this](int a, int b) { return m_ord[a] < m_ord[b]; };
+    std::sort(forward.begin(), forward.end(), byOrder);
+    std::sort(backward.begin(), backward.end(), byOrder);
+
+    QVector<int> positions;
+    positions.reserve(forward.size() + backward.size());
+    for (int node : std::as_const(backward))
+        positions.append(m_ord[node]);
+    for (int node : std::as_const(forward))
+        positions.append(m_ord[node]);
+    std::sort(positions.begin(), positions.end());
+
+    int i = 0;
+    for (int node : std::as_const(backward)) {
+        m_ord[node] = positions[i];
+        m_nodeAt[positions[i++]] = node;
+    }
+    for (int node : std::as_const(forward)) {
+        m_ord[node] = positions[i];
+        m_nodeAt[positions[i++]] = node;
+    }
+    return true;
+}
+
+bool TaskGraph::unlink(TaskId blocker, TaskId blocked, QVector<TaskId> &flipped)
+{
+    TASK_TRACE_SCOPE("TaskGraph::unlink");
+    const int from = m_nodeOf.value(blocker, -1);
+    const int to = m_nodeOf.value(blocked, -1);
+    if (from < 0 || to < 0 || !hasEdge(from, to))
+        return false;
+
+    removeEdge(from, to, flipped);
+    rebuildIfNeeded();
+    return true;
+}
+
+void TaskGraph::removeEdge(int from, int to, QVector<TaskId> &flipped)
+{
+    const auto out = m_outExtra.find(from);
+    if (out != m_outExtra.end() && out->removeOne(to)) {
+        if (out->isEmpty())
+            m_outExtra.erase(out);
+        const auto in = m_inExtra.find(to);
+        in->removeOne(from);
+        if (in->isEmpty())
+            m_inExtra.erase(in);
+        --m_extraEdges;
+    } else {
+        m_dead.insert(edgeKey(from, to));
+    }
+    --m_edges;
+
+    if (!m_done[from]) {
+        const bool wasBlocked = blockedNode(to);
+        --m_open[to];
+        if (wasBlocked && !blockedNode(to))
+            flipped.append(m_ids[to]);
+    }
+    propagateDepth(to);
+}
+
+void TaskGraph::removeTask(TaskId id, QVector<TaskId> &flipped)
+{
+    const int node = m_nodeOf.value(id, -1);
+    if (node < 0)
+        return;
+
+    QVector<int> next;
+    QVector<int> prev;
+    forEachSuccessor(node, [&next](int n) { next.append(n); });
+    forEachPredecessor(node, [&prev](int p) { prev.append(p); });
+
+    // Outgoing edges first, while the node still counts as open for its dependents
+    for (int n : std::as_const(next))
+        removeEdge(node, n, flipped);
+    for (int p : std::as_const(prev))
+        removeEdge(p, node, flipped);
+
+    m_done[node] = true;
+    m_open[node] = 0;
+    setDepth(node, 0);
+    m_nodeOf.remove(id);
+    rebuildIfNeeded();
+}
+
+void TaskGraph::setCompleted(TaskId id, bool completed, QVector<TaskId> &flipped)
+{
+    const int node = m_nodeOf.value(id, -1);
+    if (node < 0 || m_done[node] == completed)
+        return;
+
+    const bool wasBlocked = blockedNode(node);
+    m_done[node] = completed;
+    if (wasBlocked != blockedNode(node))
+        flipped.append(id);
+
+    forEachSuccessor(node, [&](int next) {
+        const bool before = blockedNode(next);
+        m_open[next] += completed ? -1 : 1;
+        if (before != blockedNode(next))
+            flipped.append(m_ids[next]);
+    });
+    propagateDepth(node);
+}
+
+void TaskGraph::setDepth(int node, int depth)
+{
+    const int old = m_depth[node];
+    if (old == depth)
+        return;
+
+    if (old > 0)
+        --m_depthCount[old];
+    if (depth > 0) {
+        if (m_depthCount.size() <= depth)
+            m_depthCount.resize(depth + 1);
+        ++m_depthCount[depth];
+    }
+    m_depth[node] = depth;
+
+    while (m_depthCount.size() > 1 && m_depthCount.last() == 0)
+        m_depthCount.removeLast();
+}
+
+void TaskGraph::propagateDepth(int start)
+{
+    // Nodes are settled in topological order, so each is recomputed once,
+    // after every predecessor that could still change
+    using Entry = std::pair<int, int>;  // position, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    m_mark[start] = true;
+    queue.push({m_ord[start], start});
+
+    while (!queue.empty()) {
+        const int node = queue.top().second;
+        queue.pop();
+        m_mark[node] = false;
+
+        int depth = 0;
+        if (!m_done[node]) {
+            int longest = 0;
+            forEachPredecessor(node, [&](int prev) { longest = qMax(longest, m_depth[prev]); });
+            depth = longest + 1;
+        }
+        if (depth == m_depth[node])
+            continue;
+
+        setDepth(node, depth);
+        forEachSuccessor(node, [&](int next) {
+            if (!m_mark[next]) {
+                m_mark[next] = true;
+                queue.push({m_ord[next], next});
+            }
+        });
+    }
+}
+
+bool TaskGraph::isBlocked(TaskId id) const
+{
+    const int node = m_nodeOf.value(id, -1);
+    return node >= 0 && blockedNode(node);
+}
+
+QVector<TaskId> TaskGraph::blockedTasks() const
+{
+    QVector<TaskId> ids;
+    for (auto it = m_nodeOf.cbegin(); it != m_nodeOf.cend(); ++it) {
+        if (blockedNode(it.value()))
+            ids.append(it.key());
+    }
+    return ids;
+}
+
+QVector<TaskId> TaskGraph::blockersOf(TaskId id) const
+{
+    QVector<TaskId> ids;
+    const int node = m_nodeOf.value(id, -1);
+    if (node >= 0)
+        forEachPredecessor(node, [&](int prev) { ids.append(m_ids[prev]); });
+    return ids;
+}
+
+QVector<TaskId> TaskGraph::dependentsOf(TaskId id) const
+{
+    QVector<TaskId> ids;
+    const int node = m_nodeOf.value(id, -1);
+    if (node >= 0)
+        forEachSuccessor(node, [&](int next) { ids.append(m_ids[next]); });
+    return ids;
+}
+
+QVector<TaskDependency> TaskGraph::dependencies() const
+{
+    QVector<TaskDependency> edges;
+    edges.reserve(m_edges);
+    for (int node = 0; node < m_ids.size(); ++node)
+        forEachSuccessor(node, [&](int next) { edges.append({m_ids[node], m_ids[next]}); });
+    return edges;
+}
+
+QVector<TaskId> TaskGraph::criticalPath() const
+{
+    TASK_TRACE_SCOPE("TaskGraph::criticalPath");
+    const int length = criticalPathLength();
+    if (length < 2)
+        return {};
+
+    // Walk back from a node at the greatest depth through predecessors one
+    // shallower; one always exists, since that is how depths are defined
+    int node = int(std::find(m_depth.cbegin(), m_depth.cend(), length) - m_depth.cbegin());
+    QVector<TaskId> path;
+    path.reserve(length);
+    path.append(m_ids[node]);
+    while (m_depth[node] > 1) {
+        int prev = -1;
+        forEachPredecessor(node, [&](int p) {
+            if (prev < 0 && m_depth[p] == m_depth[node] - 1)
+                prev = p;
+        });
+        node = prev;
+        path.append(m_ids[node]);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
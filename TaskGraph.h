@@ -0,0 +1,131 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "Task.h"
+#include "TaskTable.h"
+
+// One blocked-by edge: blocked cannot start until blocker is completed
+struct TaskDependency {
+    TaskId blocker = 0;
+    TaskId blocked = 0;
+
+    friend bool operator==(const TaskDependency &a, const TaskDependency &b)
+    {
+        return a.blocker == b.blocker && a.blocked == b.blocked;
+    }
+};
+Q_DECLARE_TYPEINFO(TaskDependency, Q_PRIMITIVE_TYPE);
+
+inline size_t qHash(const TaskDependency &dependency, size_t seed = 0)
+{
+    return qHashMulti(seed, dependency.blocker, dependency.blocked);
+}
+
+// Dependencies between tasks, kept acyclic. Only tasks with at least one
+// edge are nodes.
+//
+// Edges are stored in compressed sparse row form in both directions, so a
+// node's blockers or dependents are one contiguous, sorted slice of a flat
+// array. Edges added since the arrays were built go to small per-node
+// overflow lists and removed ones are tombstoned; the arrays are rebuilt
+// once those make up a fair share of the graph.
+//
+// A topological order is maintained across insertions (Pearce-Kelly): an
+// edge that agrees with it is accepted in O(1), and one that does not only
+// searches and reorders the nodes between its two ends, which is also the
+// only place a cycle could close.
+//
+// Per node it keeps the number of blockers still open and the length of
+// the longest chain of unfinished tasks ending there. A status change
+// adjusts its dependents' counts and pushes depth changes forward in
+// topological order, touching only what actually changed.
+class TaskGraph
+{
+public:
+    enum LinkResult {
+        Linked,
+        AlreadyLinked,
+        WouldCycle          // includes a task blocking itself
+    };
+
+    void clear();
+
+    // Replaces every edge. Status is read from tasks; edges to tasks it
+    // does not hold are dropped, as are edges that close a cycle.
+    void reset(const QVector<TaskDependency> &dependencies, const TaskTable &tasks);
+
+    // Tasks whose blocked state flips are appended to flipped. Both tasks
+    // must be in tasks, which supplies the status of new nodes.
+    LinkResult link(TaskId blocker, TaskId blocked, const TaskTable &tasks, QVector<TaskId> &flipped);
+    bool unlink(TaskId blocker, TaskId blocked, QVector<TaskId> &flipped);
+    // Drops every edge of a task that is going away
+    void removeTask(TaskId id, QVector<TaskId> &flipped);
+    void setCompleted(TaskId id, bool completed, QVector<TaskId> &flipped);
+
+    bool contains(TaskId id) const { return m_nodeOf.contains(id); }
+    int edgeCount() const { return m_edges; }
+
+    // Not completed, with at least one blocker that is not completed either
+    bool isBlocked(TaskId id) const;
+    QVector<TaskId> blockedTasks() const;
+    QVector<TaskId> blockersOf(TaskId id) const;
+    QVector<TaskId> dependentsOf(TaskId id) const;
+    QVector<TaskDependency> dependencies() const;
+
+    // Longest chain of unfinished tasks, each blocking the next; empty
+    // unless some unfinished task blocks another. The length is O(1), the
+    // chain itself costs a scan over the nodes.
+    int criticalPathLength() const { return qMax(0, int(m_depthCount.size()) - 1); }
+    QVector<TaskId> criticalPath() const;
+
+private:
+    QVector<TaskId> m_ids;              // node -> task
+    QHash<TaskId, int> m_nodeOf;        // task -> node, for live nodes
+
+    // Compressed rows over the first m_builtNodes nodes: the successors of
+    // node v are m_out[m_outStart[v] .. m_outStart[v + 1]), ascending
+    int m_builtNodes = 0;
+    QVector<int> m_outStart;
+    QVector<int> m_out;
+    QVector<int> m_inStart;
+    QVector<int> m_in;
+
+    // Changes since the rows were built
+    QHash<int, QVector<int>> m_outExtra;
+    QHash<int, QVector<int>> m_inExtra;
+    QSet<quint64> m_dead;               // removed row edges, by edgeKey()
+    int m_extraEdges = 0;
+    int m_edges = 0;
+
+    QVector<int> m_ord;                 // node -> topological position
+    QVector<int> m_nodeAt;              // topological position -> node
+    QVector<bool> m_done;
+    QVector<int> m_open;                // blockers not completed
+    QVector<int> m_depth;               // longest unfinished chain ending here; 0 if done
+    QVector<int> m_depthCount;          // nodes per depth; [0] unused, no trailing zeros
+    QVector<bool> m_mark;               // scratch for searches, all false between calls
+
+    static quint64 edgeKey(int from, int to) { return (quint64(quint32(from)) << 32) | quint32(to); }
+    bool blockedNode(int node) const { return !m_done[node] && m_open[node] > 0; }
+
+    template <typename F>
+    void forEachSuccessor(int node, F &&f) const;
+    template <typename F>
+    void forEachPredecessor(int node, F &&f) const;
+    bool inRows(int from, int to) const;     // built edge, even if tombstoned
+    bool hasEdge(int from, int to) const;
+
+    int nodeFor(TaskId id, const TaskTable &tasks);
+    void removeEdge(int from, int to, QVector<TaskId> &flipped);
+    bool reorder(int from, int to);
+    void setDepth(int node, int depth);
+    void propagateDepth(int node);
+
+    void build(const QVector<TaskId> &ids, const QVector<bool> &done, QVector<QPair<int, int>> edges);
+    void rebuildIfNeeded();
+};
+
+#endif // TASKGRAPH_H
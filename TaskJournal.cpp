@@ -0,0 +1,449 @@
+#include "TaskJournal.h"
+#include <QDataStream>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QVector>
+#include "TaskLogging.h"
+#include "TaskTrace.h"
+
+static constexpr quint32 JOURNAL_MAGIC = 0x54534B4A; // "TSKJ"
+static constexpr quint16 JOURNAL_VERSION = 3;        // v2: stamped records, header with a generation
+                                                     // v3: added tasks as plain fields, text unpadded
+static constexpr quint16 MIN_JOURNAL_VERSION = 1;
+static constexpr qint64 V1_HEADER_SIZE = sizeof(quint32) + sizeof(quint16);
+static constexpr qint64 FRAME_SIZE = sizeof(quint32) + sizeof(quint16);  // payload size + checksum
+static constexpr int LOCK_TIMEOUT_MS = 5000;
+
+static QByteArray journalHeader(quint64 generation)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << JOURNAL_MAGIC << JOURNAL_VERSION << generation;
+    return header;
+}
+
+static quint64 newGeneration()
+{
+    // Never 0, which stands for "no journal"
+    return QRandomGenerator::global()->generate64() | 1;
+}
+
+QString TaskJournal::pathFor(const QString &snapshotPath)
+{
+    return snapshotPath + QStringLiteral(".journal");
+}
+
+bool TaskJournal::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!lock())
+        return false;
+    const bool opened = reopen();
+    unlock();
+    return opened;
+}
+
+bool TaskJournal::reopen()
+{
+    const QString path = m_file.fileName();
+    Header header;
+    qint64 validSize = 0;
+    bool intact = replay(path, [](const Record &) {}, &validSize, &header.generation);
+
+    // Journals in an older layout are rewritten in the current one under a
+    // new generation; records from v1 stay unstamped
+    if (intact && validSize >= V1_HEADER_SIZE && fileVersion(path) < JOURNAL_VERSION) {
+        QVector<Record> legacy;
+        replay(path, [&legacy](const Record &record) { legacy.append(record); });
+        QSaveFile upgraded(path);
+        if (upgraded.open(QIODevice::WriteOnly)) {
+            upgraded.write(journalHeader(newGeneration()));
+            for (const Record &record : std::as_const(legacy))
+                upgraded.write(frame(record));
+        }
+        if (!upgraded.commit()) {
+            qCWarning(lcTaskJournal) << "TaskJournal: Cannot upgrade journal:" << path;
+            return false;
+        }
+        intact = replay(path, [](const Record &) {}, &validSize, &header.generation);
+    }
+
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qCWarning(lcTaskJournal) << "TaskJournal: Cannot open journal:" << path;
+        return false;
+    }
+
+    if (!intact || validSize < HeaderSize) {
+        // Unreadable header: start a fresh journal
+        m_generation = newGeneration();
+        m_file.resize(0);
+        m_file.write(journalHeader(m_generation));
+        m_file.flush();
+    } else {
+        m_generation = header.generation;
+        if (m_file.size() > validSize) {
+            qCWarning(lcTaskJournal) << "TaskJournal: Dropping" << (m_file.size() - validSize) << "bytes of damaged journal tail";
+            m_file.resize(validSize);
+        }
+    }
+    return true;
+}
+
+void TaskJournal::close()
+{
+    if (m_file.isOpen())
+        m_file.close();
+    m_generation = 0;
+}
+
+bool TaskJournal::lock()
+{
+    if (!m_shared)
+        return true;
+    if (m_lockDepth > 0) {
+        ++m_lockDepth;
+        return true;
+    }
+
+    // A lock left by a process that died is taken over by QLockFile
+    m_lock = std::make_unique<QLockFile>(m_file.fileName() + QStringLiteral(".lock"));
+    if (!m_lock->tryLock(LOCK_TIMEOUT_MS)) {
+        qCWarning(lcTaskJournal) << "TaskJournal: Cannot lock journal:" << m_file.fileName();
+        m_lock.reset();
+        return false;
+    }
+    m_lockDepth = 1;
+    return true;
+}
+
+void TaskJournal::unlock()
+{
+    if (m_lockDepth > 0 && --m_lockDepth == 0)
+        m_lock.reset();
+}
+
+qint64 TaskJournal::recordBytes() const
+{
+    return m_file.isOpen() ? qMax<qint64>(0, m_file.size() - HeaderSize) : 0;
+}
+
+bool TaskJournal::append(const Record &record)
+{
+    TASK_TRACE_SCOPE("TaskJournal::append");
+    if (!m_file.isOpen() || !lock())
+        return false;
+    if (m_shared && !followReplacement()) {
+        unlock();
+        return false;
+    }
+
+    // Opened in append mode, so this lands at the end even if another
+    // process has appended since
+    const QByteArray bytes = frame(record);
+    const bool written = m_file.write(bytes) == bytes.size() && m_file.flush();
+    unlock();
+    if (!written)
+        qCWarning(lcTaskJournal) << "TaskJournal: Failed to append record";
+    return written;
+}
+
+bool TaskJournal::followReplacement()
+{
+    QFile current(m_file.fileName());
+    if (current.open(QIODevice::ReadOnly)) {
+        QDataStream in(&current);
+        in.setVersion(QDataStream::Qt_6_5);
+        Header header;
+        if (readHeader(in, header) && header.generation == m_generation)
+            return true;
+    }
+    // Rewritten or removed under us; whoever did it folded the records it
+    // dropped into the snapshot
+    m_file.close();
+    return reopen();
+}
+
+bool TaskJournal::discardBefore(qint64 offset)
+{
+    TASK_TRACE_SCOPE("TaskJournal::discardBefore");
+    if (!m_file.isOpen() || !lock())
+        return false;
+
+    const QString path = m_file.fileName();
+
+    m_file.seek(HeaderSize + offset);
+    const QByteArray tail = m_file.readAll();
+    m_file.close();
+
+    QSaveFile rewritten(path);
+    bool ok = rewritten.open(QIODevice::WriteOnly);
+    if (ok) {
+        rewritten.write(journalHeader(newGeneration()));
+        rewritten.write(tail);
+        ok = rewritten.commit();
+        if (!ok)
+            qCWarning(lcTaskJournal) << "TaskJournal: Failed to commit rewritten journal:" << path;
+    } else {
+        qCWarning(lcTaskJournal) << "TaskJournal: Cannot rewrite journal:" << path;
+    }
+
+    const bool reopened = reopen();
+    unlock();
+    return ok && reopened;
+}
+
+bool TaskJournal::replay(const QString &path,
+                         const std::function<void(const Record &)> &apply,
+                         qint64 *validSize, quint64 *generation)
+{
+    if (validSize)
+        *validSize = 0;
+    if (generation)
+        *generation = 0;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return true;  // No journal yet
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    Header header;
+    if (!readHeader(in, header)) {
+        qCWarning(lcTaskJournal) << "TaskJournal: Invalid journal header:" << path;
+        return false;
+    }
+
+    const qint64 from = header.version < 2 ? V1_HEADER_SIZE : HeaderSize;
+    const qint64 good = readRecords(file, in, from, header.version, apply);
+    if (good < file.size())
+        qCWarning(lcTaskJournal) << "TaskJournal: Stopped replay at damaged record, offset" << good;
+
+    if (validSize)
+        *validSize = good;
+    if (generation)
+        *generation = header.generation;
+    return true;
+}
+
+bool TaskJournal::readTail(const QString &path, quint64 generation, qint64 &offset,
+                           const std::function<void(const Record &)> &apply)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return generation == 0;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    Header header;
+    if (!readHeader(in, header) || header.version != JOURNAL_VERSION || header.generation != generation)
+        return false;
+
+    // A torn or half-written frame just ends the read; the writer may not
+    // have finished it yet
+    if (offset > HeaderSize && !file.seek(offset))
+        return false;
+    offset = readRecords(file, in, qMax(offset, HeaderSize), header.version, apply);
+    return true;
+}
+
+quint16 TaskJournal::fileVersion(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+    Header header;
+    return readHeader(in, header) ? header.version : 0;
+}
+
+bool TaskJournal::readHeader(QDataStream &in, Header &header)
+{
+    quint32 magic;
+    in >> magic >> header.version;
+    if (in.status() != QDataStream::Ok || magic != JOURNAL_MAGIC
+        || header.version < MIN_JOURNAL_VERSION || header.version > JOURNAL_VERSION)
+        return false;
+    if (header.version >= 2)
+        in >> header.generation;
+    return in.status() == QDataStream::Ok;
+}
+
+qint64 TaskJournal::readRecords(QFile &file, QDataStream &in, qint64 from, quint16 version,
+                                const std::function<void(const Record &)> &apply)
+{
+    qint64 good = from;
+    while (file.size() - good >= FRAME_SIZE) {
+        quint32 size;
+        quint16 checksum;
+        in >> size >> checksum;
+        // Task text has no length limit, so neither has a record; a size
+        // running past the end is a torn frame
+        if (size > file.size() - good - FRAME_SIZE)
+            break;
+
+        QByteArray payload(size, Qt::Uninitialized);
+        if (in.readRawData(payload.data(), size) != qint64(size) || qChecksum(payload) != checksum)
+            break;
+
+        // A frame that passed its checksum was written whole; one that
+        // cannot be decoded is skipped, never treated as the damaged tail
+        Record record;
+        if (decode(payload, version, record))
+            apply(record);
+        else
+            qCWarning(lcTaskJournal) << "TaskJournal: Skipping undecodable record, offset" << good;
+        good += FRAME_SIZE + size;
+    }
+    return good;
+}
+
+QByteArray TaskJournal::frame(const Record &record)
+{
+    const QByteArray payload = encode(record);
+
+    QByteArray bytes;
+    bytes.reserve(FRAME_SIZE + payload.size());
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << quint32(payload.size()) << qChecksum(payload);
+    out.writeRawData(payload.constData(), payload.size());
+    return bytes;
+}
+
+QByteArray TaskJournal::encode(const Record &record)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+
+    out << quint8(record.op) << quint64(record.id)
+        << qint64(record.stamp.time) << quint64(record.stamp.origin);
+    switch (record.op) {
+    case AddOp: {
+        const Task &task = record.task;
+        out << task.taskName() << task.taskDescription()
+            << quint8(task.status()) << quint8(task.priority())
+            << task.createdTime() << task.completedTime()
+            << task.dueTime() << task.reminderTime();
+        break;
+    }
+    case RemoveOp:
+        break;
+    case StatusOp:
+        out << quint8(record.status) << qint64(record.timeMs);
+        break;
+    case PriorityOp:
+        out << quint8(record.priority);
+        break;
+    case EditOp:
+        out << record.task.taskName() << record.task.taskDescription();
+        break;
+    case ScheduleOp:
+        out << qint64(record.dueMs) << qint64(record.reminderMs);
+        break;
+    case LinkOp:
+    case UnlinkOp:
+        out << quint64(record.blockerId);
+        break;
+    case ReserveOp:
+        break;
+    }
+    return payload;
+}
+
+bool TaskJournal::decode(const QByteArray &payload, quint16 version, Record &outRecord)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint8 op;
+    quint64 id;
+    in >> op >> id;
+    outRecord.op = static_cast<Op>(op);
+    outRecord.id = id;
+    if (version >= 2) {
+        qint64 time;
+        quint64 origin;
+        in >> time >> origin;
+        outRecord.stamp = {time, origin};
+    }
+
+    switch (outRecord.op) {
+    case AddOp: {
+        if (version < 3) {
+            // The task blob of v1/v2 files, fixed-size fields and all
+            QByteArray bytes;
+            in >> bytes;
+            if (!Task::fromByteArray(bytes, 2, outRecord.task))
+                return false;
+            break;
+        }
+        QString name, description;
+        quint8 status, priority;
+        QDateTime created, completed, due, reminder;
+        in >> name >> description >> status >> priority
+           >> created >> completed >> due >> reminder;
+        if (status > COMPLETED || priority > HIGH)
+            return false;
+        Task task(id, name, description, static_cast<TaskPriority>(priority));
+        task.setStatus(static_cast<TaskStatus>(status));
+        task.setCreatedTime(created);
+        task.setCompletedTime(completed);
+        task.setDueTime(due);
+        task.setReminderTime(reminder);
+        outRecord.task = task;
+        break;
+    }
+    case RemoveOp:
+    case ReserveOp:
+        break;
+    case StatusOp: {
+        quint8 status;
+        qint64 timeMs;
+        in >> status >> timeMs;
+        if (status > COMPLETED)
+            return false;
+        outRecord.status = static_cast<TaskStatus>(status);
+        outRecord.timeMs = timeMs;
+        break;
+    }
+    case PriorityOp: {
+        quint8 priority;
+        in >> priority;
+        if (priority > HIGH)
+            return false;
+        outRecord.priority = static_cast<TaskPriority>(priority);
+        break;
+    }
+    case EditOp: {
+        QString name, description;
+        in >> name >> description;
+        outRecord.task.setTaskName(name);
+        outRecord.task.setTaskDescription(description);
+        break;
+    }
+    case ScheduleOp: {
+        qint64 dueMs, reminderMs;
+        in >> dueMs >> reminderMs;
+        outRecord.dueMs = dueMs;
+        outRecord.reminderMs = reminderMs;
+        break;
+    }
+    case LinkOp:
+    case UnlinkOp: {
+        quint64 blockerId;
+        in >> blockerId;
+        outRecord.blockerId = blockerId;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    return in.status() == QDataStream::Ok;
+}
@@ -0,0 +1,132 @@
+#ifndef TASKJOURNAL_H
+#define TASKJOURNAL_H
+
+#include <QFile>
+#include <QLockFile>
+#include <QString>
+#include <functional>
+#include <memory>
+#include "Task.h"
+
+// Append-only write-ahead log of task mutations, stored next to the
+// snapshot as "<snapshot>.journal". Every record is length-prefixed and
+// checksummed so a torn tail left by a crash is detected and dropped.
+// Records carry absolute values (not deltas), which makes replaying a
+// journal over a snapshot that already contains some of it harmless.
+//
+// Several processes may share one journal: appends always land at the end
+// of the file, and every record is stamped so readers can tell which of two
+// writes to the same field came last. A rewrite gives the journal a new
+// generation, by which the others notice it was replaced. Appends and
+// rewrites take "<journal>.lock", so no record lands in a file that is
+// being replaced.
+class TaskJournal
+{
+public:
+    enum Op : quint8 {
+        AddOp = 1,
+        RemoveOp,
+        StatusOp,
+        PriorityOp,
+        EditOp,
+        ScheduleOp,
+        LinkOp,
+        UnlinkOp,
+        ReserveOp                       // IDs below id are taken by the writer
+    };
+
+    // Orders writes across processes: a hybrid clock reading (wall time in
+    // ms, advanced past every stamp seen), ties broken by the writer
+    struct Stamp {
+        qint64 time = 0;
+        quint64 origin = 0;             // random per writer; 0 for unstamped v1 records
+
+        friend bool operator<(const Stamp &a, const Stamp &b)
+        {
+            return a.time != b.time ? a.time < b.time : a.origin < b.origin;
+        }
+    };
+
+    struct Record {
+        Op op = AddOp;
+        TaskId id = 0;
+        Stamp stamp;
+        Task task;                      // AddOp; name and description for EditOp
+        TaskStatus status = PENDING;    // StatusOp
+        qint64 timeMs = 0;              // StatusOp: when the status changed
+        TaskPriority priority = MEDIUM; // PriorityOp
+        qint64 dueMs = 0;               // ScheduleOp; 0 clears
+        qint64 reminderMs = 0;          // ScheduleOp; 0 clears
+        TaskId blockerId = 0;           // LinkOp, UnlinkOp: the task id waits for
+    };
+
+    // Bytes before the first record
+    static constexpr qint64 HeaderSize = sizeof(quint32) + sizeof(quint16) + sizeof(quint64);
+
+    static QString pathFor(const QString &snapshotPath);
+
+    // Opens (creating if needed) for appending; a corrupt tail is truncated
+    // and a journal in an older layout is rewritten in the current one
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    quint64 generation() const { return m_generation; }
+
+    // Shared: another process may rewrite the journal, so each append first
+    // checks that the file at the path is still the one open, and reopens
+    void setShared(bool shared) { m_shared = shared; }
+
+    // Shared: holds the lock file that append() and rewrites take, so that
+    // reading the tail and appending after it is one step for the other
+    // processes. Nests; false if the lock could not be had in time.
+    bool lock();
+    void unlock();
+
+    // Bytes of records currently in the journal, excluding the header
+    qint64 recordBytes() const;
+
+    bool append(const Record &record);
+
+    // Drops every record before offset (as returned by recordBytes()),
+    // keeping the ones appended after it
+    bool discardBefore(qint64 offset);
+
+    // Calls apply for every intact record; stops at the first damaged one.
+    // A missing file is not an error.
+    static bool replay(const QString &path,
+                       const std::function<void(const Record &)> &apply,
+                       qint64 *validSize = nullptr, quint64 *generation = nullptr);
+
+    // Calls apply for the intact records from file offset offset on, in a
+    // journal of the given generation, and advances offset past them. A
+    // record still being written is left for the next call. Returns false,
+    // reading nothing, if the journal has since been rewritten or removed;
+    // a journal that is missing and never existed (generation 0) is fine.
+    static bool readTail(const QString &path, quint64 generation, qint64 &offset,
+                         const std::function<void(const Record &)> &apply);
+
+private:
+    struct Header {
+        quint16 version = 0;
+        quint64 generation = 0;
+    };
+
+    QFile m_file;
+    quint64 m_generation = 0;
+    bool m_shared = false;
+    std::unique_ptr<QLockFile> m_lock;
+    int m_lockDepth = 0;
+
+    bool reopen();
+    bool followReplacement();
+
+    static quint16 fileVersion(const QString &path);     // 0 when unreadable
+    static bool readHeader(QDataStream &in, Header &header);
+    static qint64 readRecords(QFile &file, QDataStream &in, qint64 from, quint16 version,
+                              const std::function<void(const Record &)> &apply);
+    static QByteArray frame(const Record &record);
+    static QByteArray encode(const Record &record);
+    static bool decode(const QByteArray &payload, quint16 version, Record &outRecord);
+};
+
+#endif // TASKJOURNAL_H
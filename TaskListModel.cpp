@@ -1,49 +1,107 @@
 #include "TaskListModel.h"
-#include <QDebug>
+#include "TaskLogging.h"
+#include "TaskTrace.h"
+#include <QTimeZone>
 #include <algorithm>
 
-TaskListModel::TaskListModel(TaskManager *manager, QObject *parent)
+TaskListModel::TaskListModel(TaskEngine *engine, QObject *parent)
     : QAbstractListModel(parent)
-    , m_manager(manager)
+    , m_engine(engine)
 {
-    // Connect to manager signals
-    connect(m_manager, &TaskManager::taskAdded, this, &TaskListModel::onTaskAdded);
-    connect(m_manager, &TaskManager::taskRemoved, this, &TaskListModel::onTaskRemoved);
-    connect(m_manager, &TaskManager::taskChanged, this, &TaskListModel::onTaskChanged);
-    connect(m_manager, &TaskManager::tasksReset, this, &TaskListModel::onTasksReset);
+    connect(m_engine, &TaskEngine::diffsReady, this, &TaskListModel::onDiffsReady);
+    connect(m_engine, &TaskEngine::searchFinished, this, &TaskListModel::searchFinished);
+    connect(m_engine, &TaskEngine::saveFinished, this, &TaskListModel::saveFinished);
+    connect(m_engine, &TaskEngine::loadProgress, this, &TaskListModel::onLoadProgress);
+    connect(m_engine, &TaskEngine::loadingChanged, this, &TaskListModel::loadingChanged);
+    connect(m_engine, &TaskEngine::reminderDue, this, &TaskListModel::onReminderDue);
+    connect(m_engine, &TaskEngine::criticalPathChanged, this, &TaskListModel::onCriticalPathChanged);
+    connect(m_engine, &TaskEngine::dependencyRejected, this, [this](TaskId taskId, TaskId blockerId) {
+        emit dependencyRejected(static_cast<qint64>(taskId), static_cast<qint64>(blockerId));
+    });
+
+    // The engine may already hold tasks this copy has not seen
+    m_resyncRequested = true;
+    m_engine->requestSnapshot();
 }
 
 int TaskListModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_manager->tasks().size();
+    return m_fetched;
+}
+
+bool TaskListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < m_tasks.size();
+}
+
+void TaskListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+
+    const int n = qMin(PageSize, m_tasks.size() - m_fetched);
+    if (n <= 0)
+        return;
+
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + n - 1);
+    m_fetched += n;
+    endInsertRows();
+}
+
+void TaskListModel::fetchThrough(int row)
+{
+    const int end = qMin(row + 1, m_tasks.size());
+    if (m_fetched >= end)
+        return;
+
+    beginInsertRows(QModelIndex(), m_fetched, end - 1);
+    m_fetched = end;
+    endInsertRows();
 }
 
 QVariant TaskListModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_manager->tasks().size())
+    TASK_TRACE_SCOPE("TaskListModel::data");
+    if (!index.isValid() || index.row() >= m_fetched)
         return QVariant();
 
-    const Task *task = m_manager->tasks().at(index.row());
+    const TaskTable &tasks = m_tasks;
+    const int row = tableRow(index.row());
 
     switch (role) {
     case TaskIdRole:
-        return task->taskId();
+        return tasks.id(row);
     case TaskNameRole:
-        return task->taskName();
+        return tasks.name(row);
     case TaskDescriptionRole:
-        return task->taskDescription();
+        // Decoded from the snapshot on first read when loading deferred it
+        return tasks.description(row);
     case TaskStatusRole:
-        return static_cast<int>(task->status());
+        return static_cast<int>(tasks.status(row));
     case TaskPriorityRole:
-        return static_cast<int>(task->priority());
+        return static_cast<int>(tasks.priority(row));
     case TaskIsCompletedRole:
-        return task->isCompleted();
+        return tasks.status(row) == COMPLETED;
     case TaskCreatedTimeRole:
-        return task->createdTime().toString("yyyy-MM-dd hh:mm");
+        return displayFor(row).createdTime;
     case TaskCompletedTimeRole:
-        return task->isCompleted() ? task->completedTime().toString("yyyy-MM-dd hh:mm") : QString();
+        return displayFor(row).completedTime;
+    case TaskPriorityLabelRole:
+        return priorityLabel(tasks.priority(row));
+    case TaskStatusLabelRole:
+        return statusLabel(tasks.status(row));
+    case TaskDueTimeRole:
+        return displayFor(row).dueTime;
+    case TaskReminderTimeRole:
+        return displayFor(row).reminderTime;
+    case TaskIsOverdueRole:
+        // Refreshed by the engine's Change diff when the due time passes
+        return tasks.dueMs(row) != 0 && tasks.status(row) != COMPLETED
+               && tasks.dueMs(row) <= QDateTime::currentMSecsSinceEpoch();
+    case TaskIsBlockedRole:
+        return tasks.isBlocked(row);
     default:
         return QVariant();
     }
@@ -60,180 +118,556 @@ QHash<int, QByteArray> TaskListModel::roleNames() const
     roles[TaskIsCompletedRole] = "isCompleted";
     roles[TaskCreatedTimeRole] = "createdTime";
     roles[TaskCompletedTimeRole] = "completedTime";
+    roles[TaskPriorityLabelRole] = "priorityLabel";
+    roles[TaskStatusLabelRole] = "statusLabel";
+    roles[TaskDueTimeRole] = "dueTime";
+    roles[TaskReminderTimeRole] = "reminderTime";
+    roles[TaskIsOverdueRole] = "isOverdue";
+    roles[TaskIsBlockedRole] = "isBlocked";
     return roles;
 }
 
+const TaskListModel::DisplayCache &TaskListModel::displayFor(int row) const
+{
+    const TaskTable &tasks = m_tasks;
+    auto it = m_displayCache.find(tasks.id(row));
+    if (it != m_displayCache.end())
+        return *it;
+
+    static const QString format = QStringLiteral("yyyy-MM-dd hh:mm");
+    DisplayCache entry;
+    entry.createdTime = QDateTime::fromMSecsSinceEpoch(tasks.createdMs(row), QTimeZone::UTC).toString(format);
+    if (tasks.status(row) == COMPLETED)
+        entry.completedTime = QDateTime::fromMSecsSinceEpoch(tasks.completedMs(row), QTimeZone::UTC).toString(format);
+    if (tasks.dueMs(row) != 0)
+        entry.dueTime = QDateTime::fromMSecsSinceEpoch(tasks.dueMs(row), QTimeZone::UTC).toString(format);
+    if (tasks.reminderMs(row) != 0)
+        entry.reminderTime = QDateTime::fromMSecsSinceEpoch(tasks.reminderMs(row), QTimeZone::UTC).toString(format);
+    return *m_displayCache.insert(tasks.id(row), entry);
+}
+
+const QString &TaskListModel::priorityLabel(TaskPriority priority)
+{
+    static const QString labels[] = {
+        QStringLiteral("Low"), QStringLiteral("Medium"), QStringLiteral("High")
+    };
+    static const QString unknown = QStringLiteral("Unknown");
+    return priority <= HIGH ? labels[priority] : unknown;
+}
+
+const QString &TaskListModel::statusLabel(TaskStatus status)
+{
+    static const QString labels[] = {
+        QStringLiteral("Pending"), QStringLiteral("In Progress"), QStringLiteral("Completed")
+    };
+    static const QString unknown = QStringLiteral("Unknown");
+    return status <= COMPLETED ? labels[status] : unknown;
+}
+
 void TaskListModel::addTask(const QString &name, const QString &description, int priority)
 {
     TaskPriority prio = static_cast<TaskPriority>(priority);
-    m_manager->addTask(name, description, prio);
+    m_engine->addTask(name, description, prio);
 }
 
-void TaskListModel::removeTask(int taskId)
+// The row goes once the engine's Remove diff arrives
+void TaskListModel::removeTask(qint64 taskId)
 {
-    qDebug() << "TaskListModel: Removing task with ID:" << taskId;
-
-    // Find the row before removal
-    int row = findRowByTaskId(static_cast<uint8_t>(taskId));
-    if (row >= 0) {
-        qDebug() << "TaskListModel: Found task at row:" << row;
+    qCDebug(lcTaskModel) << "TaskListModel: Removing task with ID:" << taskId;
+    m_engine->removeTask(static_cast<TaskId>(taskId));
+}
 
-        // Notify model that we're about to remove a row
-        beginRemoveRows(QModelIndex(), row, row);
+// Change notifications come back as Change diffs and are coalesced by
+// markDirty()/flushChanges()
+void TaskListModel::completeTask(qint64 taskId)
+{
+    qCDebug(lcTaskModel) << "TaskListModel: Completing task with ID:" << taskId;
+    m_engine->completeTask(static_cast<TaskId>(taskId));
+}
 
-        // Actually remove the task
-        bool success = m_manager->removeTask(static_cast<uint8_t>(taskId));
+void TaskListModel::startTask(qint64 taskId)
+{
+    qCDebug(lcTaskModel) << "TaskListModel: Starting task with ID:" << taskId;
+    m_engine->doTask(static_cast<TaskId>(taskId));
+}
 
-        // End the removal notification
-        endRemoveRows();
+void TaskListModel::resetTask(qint64 taskId)
+{
+    qCDebug(lcTaskModel) << "TaskListModel: Resetting task with ID:" << taskId;
+    m_engine->resetTask(static_cast<TaskId>(taskId));
+}
 
-        if (success) {
-            emit countChanged();
-            qDebug() << "TaskListModel: Task removed successfully. New count:" << m_manager->tasks().size();
-        } else {
-            qDebug() << "TaskListModel: Failed to remove task";
-        }
-    } else {
-        qDebug() << "TaskListModel: Task not found with ID:" << taskId;
+void TaskListModel::addTasks(const QVariantList &tasks)
+{
+    QVector<TaskManager::NewTask> drafts;
+    drafts.reserve(tasks.size());
+    for (const QVariant &entry : tasks) {
+        const QVariantMap map = entry.toMap();
+        TaskManager::NewTask draft;
+        draft.name = map.value("name").toString();
+        draft.description = map.value("description").toString();
+        draft.priority = static_cast<TaskPriority>(map.value("priority", int(MEDIUM)).toInt());
+        drafts.append(draft);
     }
+    m_engine->addTasks(drafts);
 }
 
-void TaskListModel::completeTask(int taskId)
+void TaskListModel::removeTasks(const QVariantList &taskIds)
 {
-    qDebug() << "TaskListModel: Completing task with ID:" << taskId;
-    if (m_manager->completeTask(static_cast<uint8_t>(taskId))) {
-        int row = findRowByTaskId(static_cast<uint8_t>(taskId));
-        if (row >= 0) {
-            QModelIndex idx = index(row);
-            emit dataChanged(idx, idx);
-            qDebug() << "TaskListModel: Task completed, UI updated";
-        }
-    }
+    qCDebug(lcTaskModel) << "TaskListModel: Removing" << taskIds.size() << "tasks";
+    m_engine->removeTasks(toTaskIds(taskIds));
 }
 
-void TaskListModel::startTask(int taskId)
+void TaskListModel::setStatus(const QVariantList &taskIds, int status)
 {
-    qDebug() << "TaskListModel: Starting task with ID:" << taskId;
-    if (m_manager->doTask(static_cast<uint8_t>(taskId))) {
-        int row = findRowByTaskId(static_cast<uint8_t>(taskId));
-        if (row >= 0) {
-            QModelIndex idx = index(row);
-            emit dataChanged(idx, idx);
-            qDebug() << "TaskListModel: Task started, UI updated";
-        }
-    }
+    m_engine->setStatus(toTaskIds(taskIds), static_cast<TaskStatus>(status));
 }
 
-void TaskListModel::resetTask(int taskId)
+void TaskListModel::setPriority(const QVariantList &taskIds, int priority)
 {
-    qDebug() << "TaskListModel: Resetting task with ID:" << taskId;
+    m_engine->setPriority(toTaskIds(taskIds), static_cast<TaskPriority>(priority));
+}
 
-    if (m_manager->resetTask(static_cast<uint8_t>(taskId))) {
-        // Find the row of the task to emit dataChanged
-        int row = findRowByTaskId(static_cast<uint8_t>(taskId));
-        if (row >= 0) {
-            QModelIndex idx = index(row);
-            emit dataChanged(idx, idx, {TaskStatusRole, TaskCompletedTimeRole, TaskIsCompletedRole});
-            qDebug() << "TaskListModel: Task reset to Pending, UI updated";
-        }
-    } else {
-        qDebug() << "TaskListModel: Failed to reset task with ID:" << taskId;
-    }
+QVariantList TaskListModel::taskIdsWithStatus(int status) const
+{
+    QVariantList ids;
+    for (int row : m_tasks.rowsWithStatus(static_cast<TaskStatus>(status)))
+        ids.append(m_tasks.id(row));
+    return ids;
+}
+
+QVector<TaskId> TaskListModel::toTaskIds(const QVariantList &taskIds)
+{
+    QVector<TaskId> ids;
+    ids.reserve(taskIds.size());
+    for (const QVariant &id : taskIds)
+        ids.append(id.value<TaskId>());
+    return ids;
+}
+
+void TaskListModel::editTask(qint64 taskId, const QString &name, const QString &description)
+{
+    m_engine->editTask(static_cast<TaskId>(taskId), name, description);
+}
+
+void TaskListModel::setDueDate(qint64 taskId, const QDateTime &due, const QDateTime &reminder)
+{
+    m_engine->setSchedule(static_cast<TaskId>(taskId),
+                          due.isValid() ? due.toMSecsSinceEpoch() : 0,
+                          reminder.isValid() ? reminder.toMSecsSinceEpoch() : 0);
+}
+
+void TaskListModel::addDependency(qint64 taskId, qint64 blockerId)
+{
+    m_engine->addDependency(static_cast<TaskId>(taskId), static_cast<TaskId>(blockerId));
+}
+
+void TaskListModel::removeDependency(qint64 taskId, qint64 blockerId)
+{
+    m_engine->removeDependency(static_cast<TaskId>(taskId), static_cast<TaskId>(blockerId));
+}
+
+QVariantList TaskListModel::readyTaskIds() const
+{
+    // Uses the ready index when this copy came from a worker table that
+    // had one; otherwise scans the status column
+    QVariantList ids;
+    for (TaskId id : m_tasks.readyIds())
+        ids.append(id);
+    return ids;
+}
+
+void TaskListModel::onCriticalPathChanged(const QVector<TaskId> &taskIds)
+{
+    m_criticalPath.clear();
+    m_criticalPath.reserve(taskIds.size());
+    for (TaskId id : taskIds)
+        m_criticalPath.append(id);
+    emit criticalPathChanged();
 }
+
+void TaskListModel::onReminderDue(TaskId taskId)
+{
+    // The task may have gone from this copy in a batch still on its way
+    const int row = m_tasks.rowOf(taskId);
+    emit reminderDue(static_cast<qint64>(taskId), row >= 0 ? m_tasks.name(row) : QString());
+}
+
+void TaskListModel::search(const QString &query)
+{
+    m_engine->search(query);
+}
+
 void TaskListModel::saveToFile()
 {
-    m_manager->save();
+    // Written on a worker thread; saveFinished() reports the outcome
+    m_engine->saveAsync();
 }
 
 void TaskListModel::loadFromFile()
 {
-    qDebug() << "TaskListModel: Loading from file...";
-    bool success = m_manager->load();
-    qDebug() << "TaskListModel: Load" << (success ? "successful" : "failed");
-    qDebug() << "TaskListModel: Task count after load:" << m_manager->tasks().size();
+    qCDebug(lcTaskModel) << "TaskListModel: Loading from file...";
+    // Arrives as a Reset diff
+    m_engine->load();
 }
 
 QString TaskListModel::priorityToString(int priority) const
 {
-    switch (static_cast<TaskPriority>(priority)) {
-    case LOW: return "Low";
-    case MEDIUM: return "Medium";
-    case HIGH: return "High";
-    default: return "Unknown";
-    }
+    if (priority < LOW || priority > HIGH)
+        return QStringLiteral("Unknown");
+    return priorityLabel(static_cast<TaskPriority>(priority));
 }
 
 QString TaskListModel::statusToString(int status) const
 {
-    switch (static_cast<TaskStatus>(status)) {
-    case PENDING: return "Pending";
-    case IN_PROGRESS: return "In Progress";
-    case COMPLETED: return "Completed";
-    default: return "Unknown";
+    if (status < PENDING || status > COMPLETED)
+        return QStringLiteral("Unknown");
+    return statusLabel(static_cast<TaskStatus>(status));
+}
+
+void TaskListModel::onDiffsReady(const TaskDiffBatch &batch)
+{
+    TASK_TRACE_SCOPE("TaskListModel::onDiffsReady");
+    // A batch continues from this copy's version. One that starts elsewhere
+    // can still be applied from its last Reset on, which replaces the copy
+    // anyway; otherwise batches went missing, so ask for the whole table
+    // once and skip batches until it arrives.
+    int start = 0;
+    if (batch.fromVersion != m_version) {
+        start = -1;
+        for (int i = batch.diffs.size() - 1; i >= 0 && start < 0; --i) {
+            if (batch.diffs.at(i).kind == TaskDiff::Reset)
+                start = i;
+        }
+        if (start < 0) {
+            if (!m_resyncRequested) {
+                qCWarning(lcTaskModel) << "TaskListModel: Missed changes" << m_version << "to"
+                                       << batch.fromVersion << "- requesting a snapshot";
+                m_resyncRequested = true;
+                m_engine->requestSnapshot();
+            }
+            return;
+        }
+    }
+
+    for (int i = start; i < batch.diffs.size(); ++i) {
+        if (batch.diffs.at(i).kind == TaskDiff::Reset)
+            m_resyncRequested = false;
+        applyDiff(batch.diffs.at(i));
     }
+    m_version = batch.toVersion;
+
+    emit statsChanged();
 }
 
-void TaskListModel::onTaskAdded(Task *task)
+void TaskListModel::applyDiff(const TaskDiff &diff)
 {
-    Q_UNUSED(task)
-    int row = m_manager->tasks().size() - 1;
-    beginInsertRows(QModelIndex(), row, row);
-    endInsertRows();
+    switch (diff.kind) {
+    case TaskDiff::Insert:
+        applyInsert(diff.row, diff.rows);
+        break;
+    case TaskDiff::Remove:
+        applyRemove(diff.id);
+        break;
+    case TaskDiff::RemoveRows:
+        applyRemoveRows(diff.order);
+        break;
+    case TaskDiff::Move:
+        applyMove(diff.row, diff.last);
+        break;
+    case TaskDiff::Change:
+        applyChange(diff.rows, diff.fields);
+        break;
+    case TaskDiff::Reorder:
+        applyReorder(diff.order);
+        break;
+    case TaskDiff::Append:
+        applyAppend(diff.rows);
+        break;
+    case TaskDiff::Reset:
+        applyReset(diff.rows);
+        break;
+    }
+}
+
+void TaskListModel::applyInsert(int row, const TaskTable &rows)
+{
+    // Shown if it lands among the exposed rows, or if everything was exposed
+    const bool exposed = row < m_fetched || m_fetched == m_tasks.size();
+    if (exposed)
+        beginInsertRows(QModelIndex(), row, row);
+    m_tasks.append(rows);
+    m_tasks.move(m_tasks.size() - 1, row);
+    if (exposed) {
+        ++m_fetched;
+        endInsertRows();
+    }
+    emit countChanged();
+}
+
+void TaskListModel::applyRemove(TaskId taskId)
+{
+    const int row = m_tasks.rowOf(taskId);
+    if (row < 0)
+        return;
+
+    m_displayCache.remove(taskId);
+
+    // Rows not paged in yet leave without a notification
+    const bool exposed = row < m_fetched;
+    if (exposed)
+        beginRemoveRows(QModelIndex(), row, row);
+    m_tasks.removeAt(row);
+    if (exposed) {
+        --m_fetched;
+        endRemoveRows();
+    }
     emit countChanged();
 }
 
-void TaskListModel::onTaskRemoved(uint8_t taskId)
+quint32 TaskListModel::rolesFor(TaskManager::ChangedFields fields)
 {
-    // This signal is emitted AFTER the task is already removed from the manager
-    // So we don't need to call beginRemoveRows/endRemoveRows here
-    // The removal is already handled in removeTask() method
-    qDebug() << "TaskListModel::onTaskRemoved signal received for task ID:" << taskId;
+    quint32 roles = 0;
+    if (fields & TaskManager::StatusField)
+        roles |= roleBit(TaskStatusRole) | roleBit(TaskIsCompletedRole) | roleBit(TaskCompletedTimeRole)
+                 | roleBit(TaskStatusLabelRole) | roleBit(TaskIsOverdueRole);
+    if (fields & TaskManager::PriorityField)
+        roles |= roleBit(TaskPriorityRole) | roleBit(TaskPriorityLabelRole);
+    if (fields & TaskManager::NameField)
+        roles |= roleBit(TaskNameRole);
+    if (fields & TaskManager::DescriptionField)
+        roles |= roleBit(TaskDescriptionRole);
+    if (fields & TaskManager::ScheduleField)
+        roles |= roleBit(TaskDueTimeRole) | roleBit(TaskReminderTimeRole) | roleBit(TaskIsOverdueRole);
+    if (fields & TaskManager::BlockedField)
+        roles |= roleBit(TaskIsBlockedRole);
+    return roles;
 }
 
-void TaskListModel::onTaskChanged(Task *task)
+void TaskListModel::markDirty(TaskId taskId, quint32 roles)
 {
-    int row = findRowByTaskId(task->taskId());
-    if (row >= 0) {
-        QModelIndex idx = index(row);
-        emit dataChanged(idx, idx);
+    // Rows can move before the flush, so changes are tracked by task ID
+    m_dirtyRoles[taskId] |= roles;
+    if (roles & (roleBit(TaskCompletedTimeRole) | roleBit(TaskDueTimeRole)))
+        m_displayCache.remove(taskId);
+
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &TaskListModel::flushChanges, Qt::QueuedConnection);
     }
 }
 
-void TaskListModel::onTasksReset()
+void TaskListModel::flushChanges()
 {
-    beginResetModel();
-    endResetModel();
+    TASK_TRACE_SCOPE("TaskListModel::flushChanges");
+    m_flushScheduled = false;
+    if (m_dirtyRoles.isEmpty())
+        return;
+
+    // Resolve to current rows; removed tasks simply drop out
+    QVector<QPair<int, quint32>> dirty;
+    dirty.reserve(m_dirtyRoles.size());
+    for (auto it = m_dirtyRoles.cbegin(); it != m_dirtyRoles.cend(); ++it) {
+        const int row = m_tasks.rowOf(it.key());
+        if (row >= 0 && row < m_fetched)
+            dirty.append({row, it.value()});
+    }
+    m_dirtyRoles.clear();
+
+    std::sort(dirty.begin(), dirty.end());
+
+    // One dataChanged per run of adjacent rows with the same role set
+    int i = 0;
+    while (i < dirty.size()) {
+        const int first = dirty[i].first;
+        const quint32 roles = dirty[i].second;
+        int last = first;
+        while (i + 1 < dirty.size() && dirty[i + 1].first == last + 1 && dirty[i + 1].second == roles) {
+            ++i;
+            ++last;
+        }
+        ++i;
+
+        QList<int> roleList;
+        for (int role = TaskIdRole; role <= LastTaskRole; ++role) {
+            if (roles & roleBit(role))
+                roleList.append(role);
+        }
+        emit dataChanged(index(first), index(last), roleList);
+    }
+}
+
+void TaskListModel::applyRemoveRows(const QVector<int> &rows)
+{
+    TASK_TRACE_SCOPE("TaskListModel::applyRemoveRows");
+    for (int row : rows)
+        m_displayCache.remove(m_tasks.id(row));
+
+    // Only exposed rows are announced, one run at a time from the bottom
+    // up, as Qt's models require. Taking each run out of the columns would
+    // shift everything below it again, so the table is compacted once at
+    // the end and data() reads around the runs announced meanwhile.
+    auto end = std::lower_bound(rows.cbegin(), rows.cend(), m_fetched);
+    while (end != rows.cbegin()) {
+        auto first = end - 1;
+        while (first != rows.cbegin() && *(first - 1) == *first - 1)
+            --first;
+        beginRemoveRows(QModelIndex(), *first, *(end - 1));
+        m_removing.append({*first, *(end - 1)});
+        m_fetched -= int(end - first);
+        endRemoveRows();
+        end = first;
+    }
+    m_removing.clear();
+    m_tasks.removeRows(rows);
     emit countChanged();
 }
 
-int TaskListModel::findRowByTaskId(uint8_t taskId) const
+int TaskListModel::tableRow(int row) const
+{
+    // Runs still in the table all lie above the one being announced
+    for (auto it = m_removing.crbegin(); it != m_removing.crend() && it->first <= row; ++it)
+        row += it->second - it->first + 1;
+    return row;
+}
+
+void TaskListModel::applyMove(int from, int to)
 {
-    const QVector<Task*> &tasks = m_manager->tasks();
-    for (int i = 0; i < tasks.size(); ++i) {
-        if (tasks[i]->taskId() == taskId)
-            return i;
+    TASK_TRACE_SCOPE("TaskListModel::applyMove");
+    // The exposed rows stay a prefix of the table, so a row crossing its
+    // end enters or leaves the model
+    const bool fromExposed = from < m_fetched;
+    const bool toExposed = to < m_fetched;
+
+    if (fromExposed && toExposed) {
+        // beginMoveRows takes the destination in pre-move coordinates
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+        m_tasks.move(from, to);
+        endMoveRows();
+    } else if (fromExposed) {
+        beginRemoveRows(QModelIndex(), from, from);
+        m_tasks.move(from, to);
+        --m_fetched;
+        endRemoveRows();
+    } else if (toExposed) {
+        beginInsertRows(QModelIndex(), to, to);
+        m_tasks.move(from, to);
+        ++m_fetched;
+        endInsertRows();
+    } else {
+        m_tasks.move(from, to);
     }
-    return -1;
 }
 
-void TaskListModel::sortByPriority(bool ascending)
+void TaskListModel::applyReorder(const QVector<int> &order)
 {
-    qDebug() << "TaskListModel: Sorting by priority, ascending:" << ascending;
+    TASK_TRACE_SCOPE("TaskListModel::applyReorder");
+    emit layoutAboutToBeChanged();
+    m_tasks.permute(order);
 
-    beginResetModel();
+    QVector<int> newRowOf(order.size());
+    for (int newRow = 0; newRow < order.size(); ++newRow)
+        newRowOf[order[newRow]] = newRow;
+
+    // The exposed rows are now the first m_fetched of the new order; rows
+    // sorted past that drop out until fetched again
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex &idx : from) {
+        const int newRow = newRowOf.value(idx.row(), idx.row());
+        to.append(newRow < m_fetched ? index(newRow) : QModelIndex());
+    }
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged();
+}
 
-    QVector<Task*> &tasks = const_cast<QVector<Task*>&>(m_manager->tasks());
+void TaskListModel::applyChange(const TaskTable &rows, TaskManager::ChangedFields fields)
+{
+    const quint32 roles = rolesFor(fields);
+    for (int i = 0; i < rows.size(); ++i) {
+        const int row = m_tasks.rowOf(rows.id(i));
+        if (row < 0)
+            continue;
 
-    // Sort tasks by priority
-    std::sort(tasks.begin(), tasks.end(), [ascending](Task* a, Task* b) {
-        if (ascending) {
-            return a->priority() < b->priority();  // LOW -> MEDIUM -> HIGH
-        } else {
-            return a->priority() > b->priority();  // HIGH -> MEDIUM -> LOW
+        if (fields & TaskManager::StatusField)
+            m_tasks.setStatus(row, rows.status(i), rows.completedMs(i));
+        if (fields & TaskManager::PriorityField)
+            m_tasks.setPriority(row, rows.priority(i));
+        if (fields & TaskManager::NameField)
+            m_tasks.setName(row, rows.name(i));
+        if (fields & TaskManager::DescriptionField)
+            m_tasks.setDescription(row, rows.description(i));
+        if (fields & TaskManager::ScheduleField) {
+            m_tasks.setDueMs(row, rows.dueMs(i));
+            m_tasks.setReminderMs(row, rows.reminderMs(i));
         }
-    });
+        if (fields & TaskManager::BlockedField)
+            m_tasks.setBlocked(row, rows.isBlocked(i));
+        markDirty(rows.id(i), roles);
+    }
+}
+
+void TaskListModel::applyAppend(const TaskTable &rows)
+{
+    TASK_TRACE_SCOPE("TaskListModel::applyAppend");
+    const int first = m_tasks.size();
+    const int last = first + rows.size() - 1;
+
+    // The first batch of a load brings the pool the rest share
+    if (m_tasks.isEmpty())
+        m_tasks.adoptStrings(rows.strings());
+
+    // Appended after fully exposed rows: show up to a page of them, the
+    // rest (e.g. later batches of a background load) on fetchMore()
+    if (m_fetched == first && !rows.isEmpty()) {
+        const int end = qMin(last, first + PageSize - 1);
+        beginInsertRows(QModelIndex(), first, end);
+        m_tasks.append(rows);
+        m_fetched = end + 1;
+        endInsertRows();
+    } else {
+        m_tasks.append(rows);
+    }
+    emit countChanged();
+}
+
+void TaskListModel::applyReset(const TaskTable &rows)
+{
+    TASK_TRACE_SCOPE("TaskListModel::applyReset");
+    // A reset refreshes every row anyway
+    m_dirtyRoles.clear();
+    m_displayCache.clear();
 
+    // Paging starts over from the first page
+    beginResetModel();
+    m_tasks = rows;
+    m_fetched = qMin(PageSize, m_tasks.size());
     endResetModel();
+    emit countChanged();
+}
+
+void TaskListModel::onLoadProgress(int loaded, int total)
+{
+    m_loadProgress = total > 0 ? qreal(loaded) / total : 1.0;
+    emit loadProgressChanged();
+}
+
+int TaskListModel::findRowByTaskId(TaskId taskId) const
+{
+    return m_tasks.rowOf(taskId);
+}
+
+void TaskListModel::sortByPriority(bool ascending)
+{
+    qCDebug(lcTaskModel) << "TaskListModel: Sorting by priority, ascending:" << ascending;
 
-    qDebug() << "TaskListModel: Sorting complete";
+    // Reported back as a layout change, so delegates survive the sort
+    m_engine->sortByPriority(ascending);
+}
+
+void TaskListModel::clearSortOrder()
+{
+    m_engine->setSortOrder({});
 }
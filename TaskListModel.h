@@ -2,12 +2,36 @@
 #define TASKLISTMODEL_H
 
 #include <QAbstractListModel>
-#include "TaskManager.h"
+#include "TaskEngine.h"
 
+// Rows are the manager's tasks in order, paged in: the model starts with
+// the first PageSize rows and views pull more through fetchMore() as they
+// scroll, so delegates and per-row work scale with what is on screen.
+// `count` is always the total number of tasks.
+//
+// The tasks themselves live on TaskEngine's worker thread. The model keeps
+// its own copy of the table, kept current by the engine's diff batches, and
+// its actions are posted to the engine: their effect shows up once the
+// matching batch has been applied.
 class TaskListModel : public QAbstractListModel
 {
     Q_OBJECT
-    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(qreal loadProgress READ loadProgress NOTIFY loadProgressChanged)
+
+    // Aggregate counts, maintained incrementally by TaskTable
+    Q_PROPERTY(int pendingCount READ pendingCount NOTIFY statsChanged)
+    Q_PROPERTY(int inProgressCount READ inProgressCount NOTIFY statsChanged)
+    Q_PROPERTY(int completedCount READ completedCount NOTIFY statsChanged)
+    Q_PROPERTY(int activeCount READ activeCount NOTIFY statsChanged)
+    Q_PROPERTY(int lowPriorityCount READ lowPriorityCount NOTIFY statsChanged)
+    Q_PROPERTY(int mediumPriorityCount READ mediumPriorityCount NOTIFY statsChanged)
+    Q_PROPERTY(int highPriorityCount READ highPriorityCount NOTIFY statsChanged)
+    Q_PROPERTY(int blockedCount READ blockedCount NOTIFY statsChanged)
+
+    // Task IDs of the longest chain of unfinished tasks, each blocking the next
+    Q_PROPERTY(QVariantList criticalPath READ criticalPath NOTIFY criticalPathChanged)
 
 public:
     enum TaskRoles {
@@ -18,40 +42,156 @@ public:
         TaskPriorityRole,
         TaskIsCompletedRole,
         TaskCreatedTimeRole,
-        TaskCompletedTimeRole
+        TaskCompletedTimeRole,
+        TaskPriorityLabelRole,
+        TaskStatusLabelRole,
+        TaskDueTimeRole,
+        TaskReminderTimeRole,
+        TaskIsOverdueRole,
+        TaskIsBlockedRole,
+        LastTaskRole = TaskIsBlockedRole
     };
 
-    explicit TaskListModel(TaskManager *manager, QObject *parent = nullptr);
+    // Rows exposed per fetchMore()
+    static constexpr int PageSize = 256;
+
+    explicit TaskListModel(TaskEngine *engine, QObject *parent = nullptr);
 
     // QAbstractItemModel interface
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    int count() const { return m_tasks.size(); }
+    // Exposes the rows up to and including row at once, e.g. so a filter
+    // sees its last match
+    void fetchThrough(int row);
+    // Same for every remaining row
+    void fetchAll() { fetchThrough(m_tasks.size() - 1); }
+
+    // The model's copy of the tasks, as of the last applied batch
+    const TaskTable &tasks() const { return m_tasks; }
+
+    bool isLoading() const { return m_engine->isLoading(); }
+    qreal loadProgress() const { return m_loadProgress; }
+
+    int pendingCount() const { return m_tasks.statusCount(PENDING); }
+    int inProgressCount() const { return m_tasks.statusCount(IN_PROGRESS); }
+    int completedCount() const { return m_tasks.statusCount(COMPLETED); }
+    int activeCount() const { return pendingCount() + inProgressCount(); }
+    int lowPriorityCount() const { return m_tasks.priorityCount(LOW); }
+    int mediumPriorityCount() const { return m_tasks.priorityCount(MEDIUM); }
+    int highPriorityCount() const { return m_tasks.priorityCount(HIGH); }
+    int blockedCount() const { return m_tasks.blockedCount(); }
+    QVariantList criticalPath() const { return m_criticalPath; }
 
     // Invokable methods for QML
     Q_INVOKABLE void addTask(const QString &name, const QString &description, int priority);
-    Q_INVOKABLE void removeTask(int taskId);
-    Q_INVOKABLE void completeTask(int taskId);
-    Q_INVOKABLE void startTask(int taskId);
-    Q_INVOKABLE void resetTask(int taskId);
+    Q_INVOKABLE void removeTask(qint64 taskId);
+    Q_INVOKABLE void completeTask(qint64 taskId);
+    Q_INVOKABLE void startTask(qint64 taskId);
+    Q_INVOKABLE void resetTask(qint64 taskId);
+    // Batch actions; tasks is a list of {name, description, priority}
+    Q_INVOKABLE void addTasks(const QVariantList &tasks);
+    Q_INVOKABLE void removeTasks(const QVariantList &taskIds);
+    Q_INVOKABLE void setStatus(const QVariantList &taskIds, int status);
+    Q_INVOKABLE void setPriority(const QVariantList &taskIds, int priority);
+    // IDs of every task with the given status, e.g. to clear completed ones
+    Q_INVOKABLE QVariantList taskIdsWithStatus(int status) const;
+
+    Q_INVOKABLE void editTask(qint64 taskId, const QString &name, const QString &description);
+    // An invalid date clears the due or reminder time
+    Q_INVOKABLE void setDueDate(qint64 taskId, const QDateTime &due, const QDateTime &reminder);
+    // taskId waits for blockerId; a link that would close a cycle is
+    // refused and reported through dependencyRejected()
+    Q_INVOKABLE void addDependency(qint64 taskId, qint64 blockerId);
+    Q_INVOKABLE void removeDependency(qint64 taskId, qint64 blockerId);
+    // IDs of pending tasks with no open blocker, in row order
+    Q_INVOKABLE QVariantList readyTaskIds() const;
+    // Searches on the worker; IDs of matching tasks arrive in row order
+    // through searchFinished()
+    Q_INVOKABLE void search(const QString &query);
     Q_INVOKABLE void saveToFile();
     Q_INVOKABLE void loadFromFile();
     Q_INVOKABLE QString priorityToString(int priority) const;
     Q_INVOKABLE QString statusToString(int status) const;
     Q_INVOKABLE void sortByPriority(bool ascending = false);
+    Q_INVOKABLE void clearSortOrder();
 
 signals:
     void countChanged();
+    void saveFinished(bool success);
+    void loadingChanged();
+    void loadProgressChanged();
+    void statsChanged();
+    void searchFinished(const QString &query, const QVector<TaskId> &taskIds);
+    void reminderDue(qint64 taskId, const QString &taskName);
+    void dependencyRejected(qint64 taskId, qint64 blockerId);
+    void criticalPathChanged();
 
 private slots:
-    void onTaskAdded(Task *task);
-    void onTaskRemoved(uint8_t taskId);
-    void onTaskChanged(Task *task);
-    void onTasksReset();
+    void onDiffsReady(const TaskDiffBatch &batch);
+    void onLoadProgress(int loaded, int total);
+    void onReminderDue(TaskId taskId);
+    void onCriticalPathChanged(const QVector<TaskId> &taskIds);
 
 private:
-    TaskManager *m_manager;
-    int findRowByTaskId(uint8_t taskId) const;
+    TaskEngine *m_engine;
+    qreal m_loadProgress = 0;
+    QVariantList m_criticalPath;
+
+    // GUI-side copy of the engine's table at version m_version
+    TaskTable m_tasks;
+    quint64 m_version = 0;
+    bool m_resyncRequested = false;   // waiting for a Reset after a gap
+
+    // Rows exposed so far: the first m_fetched rows of the manager's table
+    int m_fetched = 0;
+
+    // Runs applyRemoveRows() has announced but not yet taken out of
+    // m_tasks, highest first; tableRow() reads around them
+    QVector<QPair<int, int>> m_removing;
+    int tableRow(int row) const;
+
+    // Formatted timestamps per task, filled on first read and dropped when
+    // the task's status or schedule changes, so scrolling doesn't reformat dates
+    struct DisplayCache {
+        QString createdTime;
+        QString completedTime;
+        QString dueTime;
+        QString reminderTime;
+    };
+    mutable QHash<TaskId, DisplayCache> m_displayCache;
+    const DisplayCache &displayFor(int row) const;
+
+    static const QString &priorityLabel(TaskPriority priority);
+    static const QString &statusLabel(TaskStatus status);
+
+    // Pending dataChanged() roles per task, one bit per role, flushed as
+    // merged row ranges once per event-loop turn
+    QHash<TaskId, quint32> m_dirtyRoles;
+    bool m_flushScheduled = false;
+
+    static constexpr quint32 roleBit(int role) { return 1u << (role - TaskIdRole); }
+    static quint32 rolesFor(TaskManager::ChangedFields fields);
+    static QVector<TaskId> toTaskIds(const QVariantList &taskIds);
+    void markDirty(TaskId taskId, quint32 roles);
+
+    // Apply one diff to m_tasks, announcing only the exposed rows
+    void applyDiff(const TaskDiff &diff);
+    void applyInsert(int row, const TaskTable &rows);
+    void applyRemove(TaskId taskId);
+    void applyRemoveRows(const QVector<int> &rows);
+    void applyMove(int from, int to);
+    void applyReorder(const QVector<int> &order);
+    void applyChange(const TaskTable &rows, TaskManager::ChangedFields fields);
+    void applyAppend(const TaskTable &rows);
+    void applyReset(const TaskTable &rows);
+
+    void flushChanges();
+    int findRowByTaskId(TaskId taskId) const;
 };
 
 #endif // TASKLISTMODEL_H
@@ -0,0 +1,7 @@
+#include "TaskLogging.h"
+
+Q_LOGGING_CATEGORY(lcTaskManager, "taskmanager.manager", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTaskStore, "taskmanager.store", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTaskJournal, "taskmanager.journal", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTaskGraph, "taskmanager.graph", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTaskModel, "taskmanager.model", QtInfoMsg)
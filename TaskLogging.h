@@ -0,0 +1,14 @@
+#ifndef TASKLOGGING_H
+#define TASKLOGGING_H
+
+#include <QLoggingCategory>
+
+// Debug output is off by default and costs one flag check per call site.
+// Turn it on with e.g. QT_LOGGING_RULES="taskmanager.*.debug=true".
+Q_DECLARE_LOGGING_CATEGORY(lcTaskManager)
+Q_DECLARE_LOGGING_CATEGORY(lcTaskStore)
+Q_DECLARE_LOGGING_CATEGORY(lcTaskJournal)
+Q_DECLARE_LOGGING_CATEGORY(lcTaskGraph)
+Q_DECLARE_LOGGING_CATEGORY(lcTaskModel)
+
+#endif // TASKLOGGING_H
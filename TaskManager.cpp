@@ -1,146 +1,1063 @@
 #include "TaskManager.h"
 #include <QFile>
-#include <QDebug>
+#include <QFileInfo>
+#include <QMap>
+#include "TaskLogging.h"
+#include "TaskTrace.h"
+#include <algorithm>
+#include <numeric>
+
+// Batches up to this size, and small next to the board, are placed row by
+// row under a sort order instead of re-sorting every row
+static constexpr int PLACE_ROWS_MAX = 32;
 
 TaskManager::TaskManager(const QString &filePath, QObject *parent)
     : QObject(parent)
     , m_store(new TaskStore(this))
     , m_filePath(filePath)
+    , m_scheduler(new TaskScheduler(this))
 {
+    connect(m_store, &TaskStore::saveFinished, this, &TaskManager::saveFinished);
+    connect(m_store, &TaskStore::loadBatchReady, this, &TaskManager::onLoadBatchReady);
+    connect(m_store, &TaskStore::loadFinished, this, &TaskManager::onLoadFinished);
+    connect(m_store, &TaskStore::loadProgress, this, &TaskManager::loadProgress);
+    connect(m_scheduler, &TaskScheduler::fired, this, &TaskManager::onScheduleFired);
+
     // Optional: auto-load on construction
     // load();
 }
 
-Task* TaskManager::addTask(const QString &name, const QString &desc, TaskPriority prio)
+TaskId TaskManager::addTask(const QString &name, const QString &desc, TaskPriority prio)
 {
-    // Determine next ID: start from 1, increment from highest
-    uint8_t newId = 1;
-    if (!m_tasks.isEmpty()) {
-        for (const Task* t : m_tasks) {  // read-only, const pointer
-            if (t->taskId() >= newId)
-                newId = t->taskId() + 1;
-        }
+    TASK_TRACE_SCOPE("TaskManager::addTask");
+    // The persisted counter is only known once loading has finished
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "addTask: Tasks are still loading";
+        return 0;
     }
 
-    Task *task = new Task(newId, name, desc, prio, this);
-    m_tasks.append(task);
+    // IDs come from the persisted counter, so no scan over existing tasks;
+    // shared, from a range reserved against the other instances
+    m_nextId = m_store->reserveIds(m_nextId, 1, m_filePath);
+    TaskId newId = m_nextId++;
 
-    // Forward completion signal
-    connect(task, &Task::taskCompleted, this, &TaskManager::onTaskCompleted);
+    Task task(newId, name, desc, prio);
+    int row = placeRow(m_tasks.append(task));
+    if (m_searchIndexed)
+        m_searchIndex.add(newId, m_tasks.name(row), m_tasks.description(row));
+    m_store->journalAdd(task);
+    compactIfNeeded();
 
-    emit taskAdded(task);
-    qDebug() << "Task added:" << task->taskName() << "(ID:" << newId << ")";
+    emit taskAdded(row);
+    emit statsChanged();
+    qCDebug(lcTaskManager) << "Task added:" << m_tasks.name(row) << "(ID:" << newId << ")";
 
-    return task;
+    return newId;
 }
 
-bool TaskManager::removeTask(uint8_t id)
+bool TaskManager::removeTask(TaskId id)
 {
+    TASK_TRACE_SCOPE("TaskManager::removeTask");
     int index = indexOfTask(id);
     if (index == -1) {
-        qWarning() << "removeTask: Task with ID" << id << "not found";
+        qCWarning(lcTaskManager) << "removeTask: Task with ID" << id << "not found";
         return false;
     }
 
-    Task *task = m_tasks.takeAt(index);
+    if (m_searchIndexed)
+        m_searchIndex.remove(id, m_tasks.name(index), m_tasks.description(index));
+    const bool linked = m_graph.contains(id);
+    QVector<TaskId> flipped;
+    m_graph.removeTask(id, flipped);
+    m_tasks.removeAt(index);
+    m_scheduler->cancel(id);
+    m_store->journalRemove(id);
+    compactIfNeeded();
     emit taskRemoved(id);
-    task->deleteLater();
+    applyBlocked(flipped);
+    emit statsChanged();
+    if (linked)
+        emit dependenciesChanged();
 
-    qDebug() << "Task removed: ID" << id;
+    qCDebug(lcTaskManager) << "Task removed: ID" << id;
     return true;
 }
 
-bool TaskManager::resetTask(uint8_t id)
+bool TaskManager::resetTask(TaskId id)
 {
-    for (Task* const it : m_tasks) {  // Task* const
-        if (it->taskId() == id) {
-            it->setStatus(PENDING);
-            return true;
-        }
+    TASK_TRACE_SCOPE("TaskManager::resetTask");
+    int row = indexOfTask(id);
+    if (row < 0)
+        return false;
+
+    if (m_tasks.status(row) != PENDING) {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_tasks.setStatus(row, PENDING, now);
+        m_store->journalStatus(id, PENDING, now);
+        compactIfNeeded();
+        row = repositionRow(row);
+        emit taskChanged(row, StatusField);
+        updateDependents({id});
+        emit statsChanged();
+    }
+    return true;
+}
+
+QVector<TaskId> TaskManager::addTasks(const QVector<NewTask> &tasks)
+{
+    TASK_TRACE_SCOPE("TaskManager::addTasks");
+    QVector<TaskId> ids;
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "addTasks: Tasks are still loading";
+        return ids;
+    }
+    if (tasks.isEmpty())
+        return ids;
+
+    ids.reserve(tasks.size());
+    m_tasks.reserve(m_tasks.size() + tasks.size());
+
+    // A few tasks are placed and announced one by one, as addTask() does
+    const bool place = placesRows(tasks.size());
+    m_nextId = m_store->reserveIds(m_nextId, tasks.size(), m_filePath);
+    const int first = m_tasks.size();
+    for (const NewTask &draft : tasks) {
+        Task task(m_nextId++, draft.name, draft.description, draft.priority);
+        int row = m_tasks.append(task);
+        if (place)
+            row = placeRow(row);
+        if (m_searchIndexed)
+            m_searchIndex.add(task.taskId(), m_tasks.name(row), m_tasks.description(row));
+        m_store->journalAdd(task);
+        ids.append(task.taskId());
+        if (place)
+            emit taskAdded(row);
+    }
+    compactIfNeeded();
+
+    // Otherwise one contiguous insert; a maintained order is restored as
+    // one layout change
+    if (!place) {
+        emit tasksAppended(first, m_tasks.size() - 1);
+        if (!m_sortKeys.isEmpty())
+            applySortOrder(true);
+    }
+    emit statsChanged();
+
+    qCDebug(lcTaskManager) << "Tasks added:" << ids.size();
+    return ids;
+}
+
+int TaskManager::removeTasks(const QVector<TaskId> &ids)
+{
+    TASK_TRACE_SCOPE("TaskManager::removeTasks");
+    return removeTaskRows(ids, true);
+}
+
+// Removals merged from another instance are already in the journal
+int TaskManager::removeTaskRows(const QVector<TaskId> &ids, bool journal)
+{
+    QVector<int> rows;
+    rows.reserve(ids.size());
+    for (TaskId id : ids) {
+        const int row = indexOfTask(id);
+        if (row >= 0)
+            rows.append(row);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return removeRows(rows, journal);
+}
+
+int TaskManager::removeRows(const QVector<int> &rows, bool journal)
+{
+    if (rows.isEmpty())
+        return 0;
+
+    bool linked = false;
+    QVector<TaskId> flipped;
+    for (int row : std::as_const(rows)) {
+        if (m_searchIndexed)
+            m_searchIndex.remove(m_tasks.id(row), m_tasks.name(row), m_tasks.description(row));
+        linked |= m_graph.contains(m_tasks.id(row));
+        m_graph.removeTask(m_tasks.id(row), flipped);
+        m_scheduler->cancel(m_tasks.id(row));
+        if (journal)
+            m_store->journalRemove(m_tasks.id(row));
     }
-    return false;
+
+    // One compaction pass however scattered the rows are, announced as a
+    // single removal
+    m_tasks.removeRows(rows);
+    emit tasksRemoved(rows);
+    if (journal)
+        compactIfNeeded();
+    applyBlocked(flipped);
+    emit statsChanged();
+    if (linked)
+        emit dependenciesChanged();
+
+    qCDebug(lcTaskManager) << "Tasks removed:" << rows.size();
+    return rows.size();
 }
 
-Task* TaskManager::getTaskById(uint8_t id) const
+int TaskManager::setStatus(const QVector<TaskId> &ids, TaskStatus status)
 {
-    for (Task* const task : m_tasks) {  // Task* const avoids detach
-        if (task->taskId() == id)
-            return task;
+    TASK_TRACE_SCOPE("TaskManager::setStatus");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const bool place = placesRows(ids.size());
+
+    QVector<TaskId> changed;
+    for (TaskId id : ids) {
+        const int row = indexOfTask(id);
+        if (row < 0 || m_tasks.status(row) == status)
+            continue;
+        m_tasks.setStatus(row, status, now);
+        m_store->journalStatus(id, status, now);
+        if (place)
+            repositionRow(row);
+        changed.append(id);
     }
-    return nullptr;
+    if (changed.isEmpty())
+        return 0;
+
+    compactIfNeeded();
+    if (!place && !m_sortKeys.isEmpty())
+        applySortOrder(true);
+    emit tasksChanged(changed, StatusField);
+    updateDependents(changed);
+    emit statsChanged();
+    return changed.size();
 }
 
-int TaskManager::indexOfTask(uint8_t id) const
+int TaskManager::setPriority(const QVector<TaskId> &ids, TaskPriority priority)
 {
-    for (int i = 0; i < m_tasks.size(); ++i) {
-        if (m_tasks[i]->taskId() == id)
-            return i;
+    TASK_TRACE_SCOPE("TaskManager::setPriority");
+    const bool place = placesRows(ids.size());
+
+    QVector<TaskId> changed;
+    for (TaskId id : ids) {
+        const int row = indexOfTask(id);
+        if (row < 0 || m_tasks.priority(row) == priority)
+            continue;
+        m_tasks.setPriority(row, priority);
+        m_store->journalPriority(id, priority);
+        if (place)
+            repositionRow(row);
+        changed.append(id);
     }
-    return -1;
+    if (changed.isEmpty())
+        return 0;
+
+    compactIfNeeded();
+    if (!place && !m_sortKeys.isEmpty())
+        applySortOrder(true);
+    emit tasksChanged(changed, PriorityField);
+    emit statsChanged();
+    return changed.size();
 }
 
-void TaskManager::onTaskCompleted(Task *task)
+bool TaskManager::editTask(TaskId id, const QString &name, const QString &desc)
 {
-    // Forward any completion (or other changes) as a general taskChanged signal
-    emit taskChanged(task);
+    TASK_TRACE_SCOPE("TaskManager::editTask");
+    int row = indexOfTask(id);
+    if (row < 0)
+        return false;
+
+    if (m_searchIndexed)
+        m_searchIndex.remove(id, m_tasks.name(row), m_tasks.description(row));
+    m_tasks.setName(row, name);
+    m_tasks.setDescription(row, desc);
+    if (m_searchIndexed)
+        m_searchIndex.add(id, name, desc);
+
+    m_store->journalEdit(id, name, desc);
+    compactIfNeeded();
+    row = repositionRow(row);
+    emit taskChanged(row, NameField | DescriptionField);
+    return true;
 }
 
-bool TaskManager::completeTask(uint8_t id)
+bool TaskManager::setSchedule(TaskId id, qint64 dueMs, qint64 reminderMs)
 {
-    for (Task* const it : m_tasks) {  // Task* const
-        if (it->taskId() == id) {
-            it->markCompleted();
-            return true;
+    TASK_TRACE_SCOPE("TaskManager::setSchedule");
+    const int row = indexOfTask(id);
+    if (row < 0)
+        return false;
+
+    m_tasks.setDueMs(row, dueMs);
+    m_tasks.setReminderMs(row, reminderMs);
+    m_scheduler->schedule(id, TaskScheduler::Due, dueMs);
+    m_scheduler->schedule(id, TaskScheduler::Reminder, reminderMs);
+
+    m_store->journalSchedule(id, dueMs, reminderMs);
+    compactIfNeeded();
+    emit taskChanged(row, ScheduleField);
+    return true;
+}
+
+void TaskManager::scheduleRows(int first, int last)
+{
+    // Scans two columns; only tasks with a time set reach the heap
+    const qint64 *due = m_tasks.dueTimes().constData();
+    const qint64 *reminder = m_tasks.reminderTimes().constData();
+    for (int row = first; row <= last; ++row) {
+        if (due[row] != 0)
+            m_scheduler->schedule(m_tasks.id(row), TaskScheduler::Due, due[row]);
+        if (reminder[row] != 0)
+            m_scheduler->schedule(m_tasks.id(row), TaskScheduler::Reminder, reminder[row]);
+    }
+}
+
+void TaskManager::rescheduleAll()
+{
+    m_scheduler->clear();
+    scheduleRows(0, m_tasks.size() - 1);
+}
+
+void TaskManager::onScheduleFired(TaskId id, TaskScheduler::Kind kind)
+{
+    const int row = indexOfTask(id);
+    if (row < 0)
+        return;
+
+    if (kind == TaskScheduler::Reminder) {
+        if (m_tasks.status(row) != COMPLETED)
+            emit reminderDue(id);
+
+        // One-shot: cleared so it does not fire again after a restart
+        m_tasks.setReminderMs(row, 0);
+        m_store->journalSchedule(id, m_tasks.dueMs(row), 0);
+        compactIfNeeded();
+    }
+    emit taskChanged(row, ScheduleField);
+}
+
+QVector<TaskId> TaskManager::search(const QString &query)
+{
+    TASK_TRACE_SCOPE("TaskManager::search");
+    const QString needle = query.trimmed();
+    if (needle.isEmpty())
+        return {};
+
+    auto matches = [this, &needle](int row) {
+        return m_tasks.name(row).contains(needle, Qt::CaseInsensitive)
+               || m_tasks.description(row).contains(needle, Qt::CaseInsensitive);
+    };
+
+    QVector<int> rows;
+    if (!TaskSearchIndex::canIndex(needle)) {
+        // Too short for trigrams
+        for (int row = 0; row < m_tasks.size(); ++row) {
+            if (matches(row))
+                rows.append(row);
+        }
+    } else {
+        if (!m_searchIndexed) {
+            for (int row = 0; row < m_tasks.size(); ++row)
+                m_searchIndex.add(m_tasks.id(row), m_tasks.name(row), m_tasks.description(row));
+            m_searchIndexed = true;
+        }
+
+        // Candidates share every trigram with the query; confirm the substring
+        const QSet<TaskId> candidates = m_searchIndex.candidates(needle);
+        for (TaskId id : candidates) {
+            const int row = m_tasks.rowOf(id);
+            if (row >= 0 && matches(row))
+                rows.append(row);
         }
+        std::sort(rows.begin(), rows.end());
     }
-    return false;
+
+    QVector<TaskId> ids;
+    ids.reserve(rows.size());
+    for (int row : std::as_const(rows))
+        ids.append(m_tasks.id(row));
+    return ids;
+}
+
+void TaskManager::invalidateSearchIndex()
+{
+    // Rebuilt by the next search
+    m_searchIndex.clear();
+    m_searchIndexed = false;
 }
 
-bool TaskManager::doTask(uint8_t id)
+Task TaskManager::getTaskById(TaskId id) const
 {
-    for (Task* const it : m_tasks) {  // Task* const
-        if (it->taskId() == id) {
-            it->setStatus(IN_PROGRESS);
-            return true;
+    int index = indexOfTask(id);
+    return index >= 0 ? m_tasks.taskAt(index) : Task();
+}
+
+int TaskManager::indexOfTask(TaskId id) const
+{
+    return m_tasks.rowOf(id);
+}
+
+void TaskManager::setSortOrder(const QVector<SortKey> &keys)
+{
+    m_sortKeys = keys;
+
+    // Rows still streaming in are sorted once loading has finished
+    if (!m_sortKeys.isEmpty() && !m_loading)
+        applySortOrder(true);
+}
+
+void TaskManager::sortByPriority(bool ascending)
+{
+    setSortOrder({{SortByPriority, ascending}, {SortByStatus, true}, {SortByCreated, true}});
+}
+
+int TaskManager::compareRows(int a, int b) const
+{
+    for (const SortKey &key : m_sortKeys) {
+        int cmp = 0;
+        switch (key.field) {
+        case SortByPriority:
+            cmp = int(m_tasks.priority(a)) - int(m_tasks.priority(b));
+            break;
+        case SortByStatus:
+            cmp = int(m_tasks.status(a)) - int(m_tasks.status(b));
+            break;
+        case SortByCreated:
+            cmp = (m_tasks.createdMs(a) > m_tasks.createdMs(b)) - (m_tasks.createdMs(a) < m_tasks.createdMs(b));
+            break;
+        case SortByName:
+            cmp = m_tasks.name(a).compare(m_tasks.name(b), Qt::CaseInsensitive);
+            break;
         }
+        if (cmp != 0)
+            return key.ascending ? cmp : -cmp;
     }
-    return false;
+    return 0;
 }
 
-bool TaskManager::load()
+void TaskManager::applySortOrder(bool notify)
 {
-    QVector<Task*> loaded;
-    if (!m_store->load(m_filePath, loaded, this)) {  // Pass parent for ownership
-        qWarning() << "Failed to load tasks from" << m_filePath;
+    TASK_TRACE_SCOPE("TaskManager::applySortOrder");
+    // Sort row numbers against the columns, then apply the order once
+    QVector<int> order(m_tasks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return compareRows(a, b) < 0;
+    });
+
+    // Already in order: nothing to move or announce
+    bool identity = true;
+    for (int i = 0; identity && i < order.size(); ++i)
+        identity = order[i] == i;
+    if (identity)
+        return;
+
+    if (notify)
+        emit tasksAboutToBeReordered();
+    m_tasks.permute(order);
+    if (notify)
+        emit tasksReordered(order);
+}
+
+int TaskManager::placeRow(int row)
+{
+    TASK_TRACE_SCOPE("TaskManager::placeRow");
+    if (m_sortKeys.isEmpty())
+        return row;
+
+    // Every other row is already in order, so only a neighbour can be out
+    // of place; binary search the side it has to move to
+    const int n = m_tasks.size();
+    int target = row;
+    if (row > 0 && compareRows(row, row - 1) < 0) {
+        // First earlier row that sorts after this one
+        int lo = 0, hi = row - 1;
+        while (lo < hi) {
+            const int mid = lo + (hi - lo) / 2;
+            if (compareRows(row, mid) < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        target = lo;
+    } else if (row + 1 < n && compareRows(row + 1, row) < 0) {
+        // Last later row that does not sort after this one
+        int lo = row + 1, hi = n;
+        while (lo < hi) {
+            const int mid = lo + (hi - lo) / 2;
+            if (compareRows(row, mid) < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        target = lo - 1;
+    }
+
+    m_tasks.move(row, target);
+    return target;
+}
+
+// Each placement moves up to the whole table, a sort only once
+bool TaskManager::placesRows(int count) const
+{
+    return !m_sortKeys.isEmpty() && count <= PLACE_ROWS_MAX && qint64(count) * PLACE_ROWS_MAX <= m_tasks.size();
+}
+
+int TaskManager::repositionRow(int row)
+{
+    const int newRow = placeRow(row);
+    if (newRow != row)
+        emit taskMoved(row, newRow);
+    return newRow;
+}
+
+bool TaskManager::completeTask(TaskId id)
+{
+    TASK_TRACE_SCOPE("TaskManager::completeTask");
+    int row = indexOfTask(id);
+    if (row < 0)
         return false;
+
+    if (m_tasks.status(row) != COMPLETED) {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_tasks.setStatus(row, COMPLETED, now);
+        m_store->journalStatus(id, COMPLETED, now);
+        compactIfNeeded();
+        row = repositionRow(row);
+        emit taskChanged(row, StatusField);
+        updateDependents({id});
+        emit statsChanged();
     }
+    return true;
+}
+
+bool TaskManager::doTask(TaskId id)
+{
+    TASK_TRACE_SCOPE("TaskManager::doTask");
+    int row = indexOfTask(id);
+    if (row < 0)
+        return false;
 
-    // Clean up old tasks
-    for (Task* const t : m_tasks) {  // Task* const avoids detach
-        t->disconnect(this);  // Avoid double signals
-        t->deleteLater();
+    if (m_tasks.status(row) != IN_PROGRESS) {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_tasks.setStatus(row, IN_PROGRESS, now);
+        m_store->journalStatus(id, IN_PROGRESS, now);
+        compactIfNeeded();
+        row = repositionRow(row);
+        emit taskChanged(row, StatusField);
+        updateDependents({id});
+        emit statsChanged();
     }
-    m_tasks.clear();
+    return true;
+}
 
-    m_tasks = loaded;
+bool TaskManager::load()
+{
+    TASK_TRACE_SCOPE("TaskManager::load");
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "load: A background load is already running";
+        return false;
+    }
 
-    // Reconnect completion signals
-    for (Task* const task : m_tasks) {  // Task* const
-        connect(task, &Task::taskCompleted, this, &TaskManager::onTaskCompleted);
+    TaskTable loaded;
+    QVector<TaskDependency> dependencies;
+    TaskId nextId = 1;
+    if (!m_store->load(m_filePath, loaded, dependencies, nextId)) {
+        qCWarning(lcTaskManager) << "Failed to load tasks from" << m_filePath;
+        return false;
     }
 
+    m_tasks = loaded;
+    m_nextId = nextId;
+    m_graph.reset(dependencies, m_tasks);
+    for (TaskId id : m_graph.blockedTasks())
+        m_tasks.setBlocked(m_tasks.rowOf(id), true);
+    invalidateSearchIndex();
+    rescheduleAll();
+    if (!m_sortKeys.isEmpty())
+        applySortOrder(false);
+
     emit tasksReset();  // Important for QML/ListView to fully refresh
-    qDebug() << "Loaded" << m_tasks.size() << "tasks from" << m_filePath;
+    emit statsChanged();
+    emit dependenciesChanged();
+    qCDebug(lcTaskManager) << "Loaded" << m_tasks.size() << "tasks from" << m_filePath;
     return true;
 }
 
 bool TaskManager::save()
 {
-    bool success = m_store->save(m_tasks, m_filePath);
+    TASK_TRACE_SCOPE("TaskManager::save");
+    // Saving a partly loaded board would drop the rest of it
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "save: Tasks are still loading";
+        return false;
+    }
+
+    bool success = m_store->save(m_tasks, m_graph.dependencies(), m_nextId, m_filePath);
     if (success) {
-        qDebug() << "Successfully saved" << m_tasks.size() << "tasks to" << m_filePath;
+        qCDebug(lcTaskManager) << "Successfully saved" << m_tasks.size() << "tasks to" << m_filePath;
     } else {
-        qWarning() << "Failed to save tasks to" << m_filePath;
+        qCWarning(lcTaskManager) << "Failed to save tasks to" << m_filePath;
     }
     return success;
 }
+
+void TaskManager::saveAsync()
+{
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "saveAsync: Tasks are still loading";
+        return;
+    }
+
+    m_store->saveAsync(m_tasks, m_graph.dependencies(), m_nextId, m_filePath);
+}
+
+void TaskManager::loadAsync()
+{
+    if (m_loading)
+        return;
+
+    m_loading = true;
+    m_tasks.clear();
+    m_graph.clear();
+    invalidateSearchIndex();
+    m_scheduler->clear();
+    emit tasksReset();
+    emit statsChanged();
+    emit loadingChanged();
+
+    m_store->loadAsync(m_filePath);
+}
+
+void TaskManager::onLoadBatchReady(const TaskTable &batch)
+{
+    TASK_TRACE_SCOPE("TaskManager::onLoadBatchReady");
+    const int first = m_tasks.size();
+    // Pooled files hand every batch the same string section; taking it
+    // over with the first means none of them is copied
+    if (m_tasks.isEmpty())
+        m_tasks.adoptStrings(batch.strings());
+    m_lastBatchPooled = m_tasks.strings().isSharedWith(batch.strings());
+    m_tasks.append(batch);
+    invalidateSearchIndex();
+    scheduleRows(first, m_tasks.size() - 1);
+    emit tasksAppended(first, m_tasks.size() - 1);
+    emit statsChanged();
+}
+
+void TaskManager::onLoadFinished(bool success, TaskId nextId, const QVector<TaskDependency> &dependencies)
+{
+    m_loading = false;
+
+    if (success) {
+        m_nextId = nextId;
+        m_graph.reset(dependencies, m_tasks);
+        applyBlocked(m_graph.blockedTasks());
+        if (m_graph.edgeCount() > 0)
+            emit dependenciesChanged();
+        if (!m_sortKeys.isEmpty())
+            applySortOrder(true);
+        if (m_syncDeferred)
+            scheduleSync();
+        qCDebug(lcTaskManager) << "Loaded" << m_tasks.size() << "tasks from" << m_filePath;
+    } else {
+        qCWarning(lcTaskManager) << "Failed to load tasks from" << m_filePath;
+        m_tasks.clear();
+        m_graph.clear();
+        invalidateSearchIndex();
+        m_scheduler->clear();
+        emit tasksReset();
+        emit statsChanged();
+    }
+    emit loadingChanged();
+}
+
+bool TaskManager::addDependency(TaskId taskId, TaskId blockerId)
+{
+    TASK_TRACE_SCOPE("TaskManager::addDependency");
+    // Edges are checked against the whole board, which is not there yet
+    if (m_loading) {
+        qCWarning(lcTaskManager) << "addDependency: Tasks are still loading";
+        return false;
+    }
+    if (!m_tasks.contains(taskId) || !m_tasks.contains(blockerId)) {
+        qCWarning(lcTaskManager) << "addDependency: Task" << taskId << "or" << blockerId << "not found";
+        return false;
+    }
+
+    QVector<TaskId> flipped;
+    switch (m_graph.link(blockerId, taskId, m_tasks, flipped)) {
+    case TaskGraph::AlreadyLinked:
+        return true;
+    case TaskGraph::WouldCycle:
+        qCWarning(lcTaskManager) << "addDependency: Task" << taskId << "waiting for" << blockerId
+                                 << "would close a cycle";
+        emit dependencyRejected(taskId, blockerId);
+        return false;
+    case TaskGraph::Linked:
+        break;
+    }
+
+    m_store->journalLink(taskId, blockerId);
+    compactIfNeeded();
+    applyBlocked(flipped);
+    emit dependenciesChanged();
+    qCDebug(lcTaskManager) << "Task" << taskId << "now waits for" << blockerId;
+    return true;
+}
+
+bool TaskManager::removeDependency(TaskId taskId, TaskId blockerId)
+{
+    TASK_TRACE_SCOPE("TaskManager::removeDependency");
+    QVector<TaskId> flipped;
+    if (!m_graph.unlink(blockerId, taskId, flipped))
+        return false;
+
+    m_store->journalUnlink(taskId, blockerId);
+    compactIfNeeded();
+    applyBlocked(flipped);
+    emit dependenciesChanged();
+    return true;
+}
+
+QVector<TaskId> TaskManager::readyTasks()
+{
+    // Blocked flags change only through applyBlocked(), which passes on the
+    // flips updateDependents() and the graph report
+    if (!m_tasks.isReadyIndexed())
+        m_tasks.indexReady();
+    return m_tasks.readyIds();
+}
+
+void TaskManager::updateDependents(const QVector<TaskId> &ids)
+{
+    // Status changes only matter to the graph when they cross COMPLETED
+    QVector<TaskId> flipped;
+    bool linked = false;
+    for (TaskId id : ids) {
+        if (!m_graph.contains(id))
+            continue;
+        linked = true;
+        m_graph.setCompleted(id, m_tasks.status(m_tasks.rowOf(id)) == COMPLETED, flipped);
+    }
+    if (!linked)
+        return;
+
+    applyBlocked(flipped);
+    emit dependenciesChanged();
+}
+
+void TaskManager::applyBlocked(QVector<TaskId> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    QVector<TaskId> changed;
+    for (TaskId id : std::as_const(ids)) {
+        const int row = indexOfTask(id);
+        const bool blocked = m_graph.isBlocked(id);
+        if (row < 0 || m_tasks.isBlocked(row) == blocked)
+            continue;
+        m_tasks.setBlocked(row, blocked);
+        changed.append(id);
+    }
+    if (!changed.isEmpty())
+        emit tasksChanged(changed, BlockedField);
+}
+
+void TaskManager::setJournalEnabled(bool enabled)
+{
+    m_store->setJournalEnabled(enabled);
+    if (enabled)
+        m_store->openJournal(m_filePath);
+}
+
+void TaskManager::compactIfNeeded()
+{
+    // A fresh snapshot drops the journal records it covers
+    if (m_store->needsCompaction() && !m_store->isSaving())
+        saveAsync();
+}
+
+void TaskManager::setLiveSyncEnabled(bool enabled)
+{
+    if (enabled == isLiveSyncEnabled())
+        return;
+
+    m_store->setShared(enabled);
+    if (!enabled) {
+        delete m_watcher;
+        m_watcher = nullptr;
+        return;
+    }
+
+    if (!isJournalEnabled())
+        setJournalEnabled(true);
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &TaskManager::scheduleSync);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &TaskManager::scheduleSync);
+    watchFiles();
+}
+
+void TaskManager::watchFiles()
+{
+    // Saves replace the files instead of writing them in place, which
+    // drops them from the watch; the directory sees the replacement, and
+    // the new files are watched again here
+    const QStringList paths{QFileInfo(m_filePath).absolutePath(), m_filePath, TaskJournal::pathFor(m_filePath)};
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    for (const QString &path : paths) {
+        if (!watched.contains(path) && QFileInfo::exists(path))
+            m_watcher->addPath(path);
+    }
+}
+
+void TaskManager::scheduleSync()
+{
+    // One write fires several notifications; merge once after all of them
+    if (m_syncScheduled)
+        return;
+    m_syncScheduled = true;
+    QMetaObject::invokeMethod(this, &TaskManager::syncFromDisk, Qt::QueuedConnection);
+}
+
+void TaskManager::syncFromDisk()
+{
+    TASK_TRACE_SCOPE("TaskManager::syncFromDisk");
+    m_syncScheduled = false;
+    if (!isLiveSyncEnabled())
+        return;
+    // Merging needs the whole board; picked up again once it is in
+    if (m_loading) {
+        m_syncDeferred = true;
+        return;
+    }
+    m_syncDeferred = false;
+    watchFiles();
+
+    QVector<TaskJournal::Record> records;
+    switch (m_store->pollChanges(m_filePath, records)) {
+    case TaskStore::NoChanges:
+        break;
+    case TaskStore::Changes:
+        applyRemote(records);
+        break;
+    case TaskStore::Rewritten:
+        mergeFromDisk();
+        break;
+    }
+}
+
+void TaskManager::applyRemote(const QVector<TaskJournal::Record> &records)
+{
+    TASK_TRACE_SCOPE("TaskManager::applyRemote");
+    // A run of records of one kind is applied and then announced with one
+    // signal, as the batch commands do. Nothing is journaled again.
+    enum Kind { None, Add, Remove, Change, Link };
+    Kind pending = None;
+    int firstAdded = -1;
+    QVector<TaskId> removed;
+    QMap<int, QVector<TaskId>> changed;     // fields -> tasks
+    QVector<TaskId> completionChanged;
+    QVector<TaskId> flipped;
+    bool linked = false;
+
+    auto flush = [&]() {
+        switch (pending) {
+        case Add:
+            if (firstAdded >= 0) {
+                scheduleRows(firstAdded, m_tasks.size() - 1);
+                emit tasksAppended(firstAdded, m_tasks.size() - 1);
+            }
+            firstAdded = -1;
+            break;
+        case Remove:
+            removeTaskRows(removed, false);
+            removed.clear();
+            break;
+        case Change:
+            for (auto it = changed.cbegin(); it != changed.cend(); ++it)
+                emit tasksChanged(it.value(), ChangedFields::fromInt(it.key()));
+            changed.clear();
+            updateDependents(completionChanged);
+            completionChanged.clear();
+            break;
+        case Link:
+            applyBlocked(flipped);
+            flipped.clear();
+            if (linked)
+                emit dependenciesChanged();
+            linked = false;
+            break;
+        case None:
+            break;
+        }
+        pending = None;
+    };
+
+    for (const TaskJournal::Record &record : records) {
+        Kind kind = Change;
+        if (record.op == TaskJournal::AddOp)
+            kind = Add;
+        else if (record.op == TaskJournal::RemoveOp)
+            kind = Remove;
+        else if (record.op == TaskJournal::LinkOp || record.op == TaskJournal::UnlinkOp)
+            kind = Link;
+        if (kind != pending)
+            flush();
+        pending = kind;
+
+        const int row = m_tasks.rowOf(record.id);
+        switch (record.op) {
+        case TaskJournal::AddOp: {
+            // Only the same task seen twice, e.g. once through a reload
+            if (row >= 0)
+                break;
+            const int added = m_tasks.append(record.task);
+            if (firstAdded < 0)
+                firstAdded = added;
+            if (m_searchIndexed)
+                m_searchIndex.add(record.id, m_tasks.name(added), m_tasks.description(added));
+            m_nextId = qMax(m_nextId, record.id + 1);
+            break;
+        }
+        case TaskJournal::RemoveOp:
+            if (row >= 0)
+                removed.append(record.id);
+            break;
+        case TaskJournal::StatusOp:
+            if (row < 0)
+                break;
+            m_tasks.setStatus(row, record.status, record.timeMs);
+            changed[StatusField].append(record.id);
+            completionChanged.append(record.id);
+            break;
+        case TaskJournal::PriorityOp:
+            if (row < 0)
+                break;
+            m_tasks.setPriority(row, record.priority);
+            changed[PriorityField].append(record.id);
+            break;
+        case TaskJournal::EditOp:
+            if (row < 0)
+                break;
+            if (m_searchIndexed)
+                m_searchIndex.remove(record.id, m_tasks.name(row), m_tasks.description(row));
+            m_tasks.setName(row, record.task.taskName());
+            m_tasks.setDescription(row, record.task.taskDescription());
+            if (m_searchIndexed)
+                m_searchIndex.add(record.id, m_tasks.name(row), m_tasks.description(row));
+            changed[(NameField | DescriptionField).toInt()].append(record.id);
+            break;
+        case TaskJournal::ScheduleOp:
+            if (row < 0)
+                break;
+            m_tasks.setDueMs(row, record.dueMs);
+            m_tasks.setReminderMs(row, record.reminderMs);
+            m_scheduler->schedule(record.id, TaskScheduler::Due, record.dueMs);
+            m_scheduler->schedule(record.id, TaskScheduler::Reminder, record.reminderMs);
+            changed[ScheduleField].append(record.id);
+            break;
+        case TaskJournal::LinkOp:
+            if (row < 0 || !m_tasks.contains(record.blockerId))
+                break;
+            // Each side may have linked half of a cycle before seeing the other
+            if (m_graph.link(record.blockerId, record.id, m_tasks, flipped) == TaskGraph::WouldCycle)
+                qCWarning(lcTaskManager) << "Live sync: Dropped a dependency of" << record.id << "on"
+                                         << record.blockerId << "that would close a cycle";
+            else
+                linked = true;
+            break;
+        case TaskJournal::UnlinkOp:
+            linked |= m_graph.unlink(record.blockerId, record.id, flipped);
+            break;
+        case TaskJournal::ReserveOp:
+            // Kept by the store, never passed on
+            break;
+        }
+    }
+    flush();
+
+    if (!m_sortKeys.isEmpty())
+        applySortOrder(true);
+    emit statsChanged();
+    qCDebug(lcTaskManager) << "Live sync: Merged" << records.size() << "changes from" << m_filePath;
+}
+
+void TaskManager::mergeFromDisk()
+{
+    TASK_TRACE_SCOPE("TaskManager::mergeFromDisk");
+    // The files were replaced, by another instance compacting the journal
+    // or by a script saving over them. Writers only drop journal records
+    // they have folded into the snapshot, so what is on disk now is the
+    // merged state; it is taken as it is, announcing only the differences.
+    TaskTable disk;
+    QVector<TaskDependency> dependencies;
+    TaskId nextId = 1;
+    if (!m_store->load(m_filePath, disk, dependencies, nextId)) {
+        qCWarning(lcTaskManager) << "Live sync: Failed to reload" << m_filePath;
+        return;
+    }
+
+    // Found in row order, so however many there are they go out as one
+    // RemoveRows diff, never a reset
+    QVector<int> removed;
+    for (int row = 0; row < m_tasks.size(); ++row) {
+        if (!disk.contains(m_tasks.id(row)))
+            removed.append(row);
+    }
+    removeRows(removed, false);
+
+    const int firstAdded = m_tasks.size();
+    QMap<int, QVector<TaskId>> changed;     // fields -> tasks
+    for (int from = 0; from < disk.size(); ++from) {
+        const TaskId id = disk.id(from);
+        const int row = m_tasks.rowOf(id);
+        if (row < 0) {
+            m_tasks.append(disk, from, 1);
+            continue;
+        }
+
+        ChangedFields fields;
+        if (m_tasks.status(row) != disk.status(from)) {
+            m_tasks.setStatus(row, disk.status(from), disk.completedMs(from));
+            fields |= StatusField;
+        }
+        if (m_tasks.priority(row) != disk.priority(from)) {
+            m_tasks.setPriority(row, disk.priority(from));
+            fields |= PriorityField;
+        }
+        if (m_tasks.nameUtf8(row) != disk.nameUtf8(from) || m_tasks.description(row) != disk.description(from)) {
+            m_tasks.setName(row, disk.name(from));
+            m_tasks.setDescription(row, disk.description(from));
+            fields |= NameField | DescriptionField;
+        }
+        if (m_tasks.dueMs(row) != disk.dueMs(from) || m_tasks.reminderMs(row) != disk.reminderMs(from)) {
+            m_tasks.setDueMs(row, disk.dueMs(from));
+            m_tasks.setReminderMs(row, disk.reminderMs(from));
+            m_scheduler->schedule(id, TaskScheduler::Due, disk.dueMs(from));
+            m_scheduler->schedule(id, TaskScheduler::Reminder, disk.reminderMs(from));
+            fields |= ScheduleField;
+        }
+        if (fields)
+            changed[fields.toInt()].append(id);
+    }
+
+    if (m_tasks.size() > firstAdded) {
+        scheduleRows(firstAdded, m_tasks.size() - 1);
+        emit tasksAppended(firstAdded, m_tasks.size() - 1);
+    }
+    for (auto it = changed.cbegin(); it != changed.cend(); ++it)
+        emit tasksChanged(it.value(), ChangedFields::fromInt(it.key()));
+    if (m_tasks.size() > firstAdded || !changed.isEmpty())
+        invalidateSearchIndex();
+    m_nextId = qMax(m_nextId, nextId);
+
+    // The graph is rebuilt from the file; only flipped rows are announced
+    m_graph.reset(dependencies, m_tasks);
+    applyBlocked(m_tasks.ids());
+    emit dependenciesChanged();
+
+    if (!m_sortKeys.isEmpty())
+        applySortOrder(true);
+    emit statsChanged();
+    qCDebug(lcTaskManager) << "Live sync: Reloaded" << m_filePath << "after it was replaced";
+}
@@ -2,64 +2,242 @@
 #define TASKMANAGER_H
 
 #include <QObject>
-#include <QVector>
 #include <QString>
+#include <QFileSystemWatcher>
 #include "Task.h"
+#include "TaskTable.h"
 #include "TaskStore.h"
+#include "TaskGraph.h"
+#include "TaskSearchIndex.h"
+#include "TaskScheduler.h"
 
 class TaskManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // Which fields of a task a taskChanged() covers
+    enum ChangedField {
+        StatusField      = 0x1,    // includes the completion time
+        PriorityField    = 0x2,
+        NameField        = 0x4,
+        DescriptionField = 0x8,
+        ScheduleField    = 0x10,   // due and reminder times, and whether overdue
+        BlockedField     = 0x20    // whether an open blocker holds the task back
+    };
+    Q_DECLARE_FLAGS(ChangedFields, ChangedField)
+
+    enum SortField {
+        SortByPriority,
+        SortByStatus,
+        SortByCreated,
+        SortByName
+    };
+
+    struct SortKey {
+        SortField field;
+        bool ascending;
+    };
+
+    struct NewTask {
+        QString name;
+        QString description;
+        TaskPriority priority = MEDIUM;
+    };
+
     explicit TaskManager(const QString &filePath, QObject *parent = nullptr);
 
-    // Add a new task
-    Task* addTask(const QString &name, const QString &desc, TaskPriority prio = MEDIUM);
+    // Add a new task, returns its ID
+    TaskId addTask(const QString &name, const QString &desc, TaskPriority prio = MEDIUM);
 
     // Remove task by ID
-    bool removeTask(uint8_t id);
+    bool removeTask(TaskId id);
+
+    bool completeTask(TaskId id);
+
+    bool doTask(TaskId id);
+
+    bool resetTask(TaskId taskId);
+
+    // Batch variants: each applies the whole set and produces a single model
+    // notification (one insert, removal, reset or change flush) instead of
+    // one per task. Unknown IDs are skipped; the count affected is returned.
+    QVector<TaskId> addTasks(const QVector<NewTask> &tasks);
+    int removeTasks(const QVector<TaskId> &ids);
+    int setStatus(const QVector<TaskId> &ids, TaskStatus status);
+    int setPriority(const QVector<TaskId> &ids, TaskPriority priority);
+
+    // Replaces name and description
+    bool editTask(TaskId id, const QString &name, const QString &desc);
 
-    bool completeTask(uint8_t id);
+    // Sets the due and reminder times (ms since the epoch, 0 = none). A
+    // reminder fires reminderDue() once and is then cleared; passing the
+    // due time emits taskChanged() so views can mark the task overdue.
+    bool setSchedule(TaskId id, qint64 dueMs, qint64 reminderMs);
 
-    bool doTask(uint8_t id);
+    // Makes taskId wait for blockerId to be completed. A link that would
+    // close a cycle is refused and reported through dependencyRejected();
+    // tasks whose blocked state flips get a tasksChanged() with BlockedField.
+    bool addDependency(TaskId taskId, TaskId blockerId);
+    bool removeDependency(TaskId taskId, TaskId blockerId);
+    QVector<TaskId> blockersOf(TaskId id) const { return m_graph.blockersOf(id); }
+    QVector<TaskId> dependentsOf(TaskId id) const { return m_graph.dependentsOf(id); }
 
-    bool resetTask(uint8_t taskId);
+    // Pending tasks that nothing holds back, in row order. The set is
+    // built on the first call and then kept up to date, blocked flags
+    // following the graph's open-blocker counts.
+    QVector<TaskId> readyTasks();
 
-    // Get task by ID (for updating or inspection)
-    Task* getTaskById(uint8_t id) const;
+    // Longest chain of unfinished tasks, each blocking the next
+    QVector<TaskId> criticalPath() const { return m_graph.criticalPath(); }
+
+    // IDs of tasks whose name or description contains query (case
+    // insensitive), in row order. Uses a trigram index that is built on
+    // the first search and then kept up to date.
+    QVector<TaskId> search(const QString &query);
+
+    // Get a copy of a task by ID (for inspection); taskId() is 0 if not found
+    Task getTaskById(TaskId id) const;
+
+    // Row of a task in tasks(), or -1. Constant time via the ID index.
+    int indexOfTask(TaskId id) const;
 
     // Access all tasks (for models/views)
-    const QVector<Task*>& tasks() const { return m_tasks; }
+    const TaskTable& tasks() const { return m_tasks; }
+
+    // Keeps tasks() ordered by keys, most significant first, with ties in
+    // their current relative order. New and changed tasks are placed by
+    // binary search, or re-sorted at once when a batch touches many of
+    // them; an empty list stops maintaining an order.
+    void setSortOrder(const QVector<SortKey> &keys);
+    const QVector<SortKey> &sortOrder() const { return m_sortKeys; }
+
+    // Priority, then status, then creation time
+    void sortByPriority(bool ascending);
 
     // Persistence
     bool load();
     bool save();
 
+    // Loads on a worker thread; rows arrive through tasksAppended() in
+    // batches. Adding, sorting and saving wait until loading has finished.
+    void loadAsync();
+    bool isLoading() const { return m_loading; }
+    // Whether the last load batch kept its text in the pool the table
+    // adopted, rather than having it copied into the table's own
+    bool lastBatchPooled() const { return m_lastBatchPooled; }
+
+    // Saves on a worker thread; the result arrives through saveFinished()
+    void saveAsync();
+
+    // Journal mode: each mutation appends a small record to the store's
+    // journal, so a crash loses nothing between saves. The journal is
+    // folded into a fresh snapshot in the background once it grows past
+    // the store's compaction threshold.
+    void setJournalEnabled(bool enabled);
+    bool isJournalEnabled() const { return m_store->isJournalEnabled(); }
+
+    // Live sync: watches the data file and its journal, and merges in what
+    // other instances or scripts write to them, the last write to each
+    // field winning. Works through the journal, so it turns that on.
+    // Merged changes are announced with the same row signals as local ones.
+    void setLiveSyncEnabled(bool enabled);
+    bool isLiveSyncEnabled() const { return m_watcher != nullptr; }
+
+    // Merges what has changed on disk since the last sync; the watcher
+    // calls this once per burst of file notifications
+    void syncFromDisk();
+
+    // Saves in the store's block-compressed, checksummed format
+    void setCompressionEnabled(bool enabled) { m_store->setCompressionEnabled(enabled); }
+    bool isCompressionEnabled() const { return m_store->isCompressionEnabled(); }
+
 signals:
-    // Emitted when a new task is added
-    void taskAdded(Task *task);
+    // Emitted when a new task is appended at row
+    void taskAdded(int row);
+
+    // Emitted when the task at row from has moved to row to
+    void taskMoved(int from, int to);
+
+    // Emitted around a reorder of all rows; order[newRow] is the old row
+    void tasksAboutToBeReordered();
+    void tasksReordered(const QVector<int> &order);
 
     // Emitted when a task is removed
-    void taskRemoved(uint8_t taskId);
+    void taskRemoved(TaskId taskId);
+
+    // Emitted after removeTasks() took out rows (ascending, numbered as
+    // they were before) in one pass
+    void tasksRemoved(const QVector<int> &rows);
 
-    // Emitted when a task is modified (name, status, priority, etc.)
-    void taskChanged(Task *task);
+    // Emitted when the same fields changed on several tasks
+    void tasksChanged(const QVector<TaskId> &ids, TaskManager::ChangedFields fields);
+
+    // Emitted when fields of the task at row are modified
+    void taskChanged(int row, TaskManager::ChangedFields fields);
 
     // Optional: emitted after full reload (useful for resetting models)
     void tasksReset();
 
-private slots:
-    // Connected internally to Task::taskCompleted to forward as taskChanged
-    void onTaskCompleted(Task *task);
+    // Emitted whenever the per-status or per-priority counts may have changed
+    void statsChanged();
+
+    // Emitted when a task's reminder time is reached, unless it is completed
+    void reminderDue(TaskId taskId);
+
+    // Emitted when an edge is added or removed, or a task with edges
+    // changes whether it is completed
+    void dependenciesChanged();
+
+    // Emitted when addDependency() would have closed a cycle
+    void dependencyRejected(TaskId taskId, TaskId blockerId);
+
+    // Emitted when a saveAsync() write has completed or failed
+    void saveFinished(bool success);
+
+    // Emitted as loadAsync() appends rows first..last
+    void tasksAppended(int first, int last);
+    void loadProgress(int loaded, int total);
+    void loadingChanged();
 
 private:
-    QVector<Task*> m_tasks;
+    TaskTable m_tasks;
+    TaskId m_nextId = 1;            // monotonic, persisted with the tasks
     TaskStore *m_store;
     QString m_filePath;
-
-    // Helper: find task index by ID
-    int indexOfTask(uint8_t id) const;
+    bool m_loading = false;
+    bool m_lastBatchPooled = false;
+    QVector<SortKey> m_sortKeys;
+    TaskSearchIndex m_searchIndex;
+    bool m_searchIndexed = false;   // false until the first search needs it
+    TaskScheduler *m_scheduler;     // due and reminder times of every task
+    TaskGraph m_graph;              // blocked-by edges; rows mirror isBlocked()
+    QFileSystemWatcher *m_watcher = nullptr;    // while live sync is on
+    bool m_syncScheduled = false;
+    bool m_syncDeferred = false;    // files changed while loading
+
+    void compactIfNeeded();
+    int removeTaskRows(const QVector<TaskId> &ids, bool journal);
+    int removeRows(const QVector<int> &rows, bool journal);     // ascending, unique
+    void scheduleSync();
+    void watchFiles();
+    void applyRemote(const QVector<TaskJournal::Record> &records);
+    void mergeFromDisk();
+    int compareRows(int a, int b) const;
+    void applySortOrder(bool notify);
+    int placeRow(int row);
+    int repositionRow(int row);
+    bool placesRows(int count) const;
+    void invalidateSearchIndex();
+    void scheduleRows(int first, int last);
+    void rescheduleAll();
+    void onScheduleFired(TaskId id, TaskScheduler::Kind kind);
+    void updateDependents(const QVector<TaskId> &ids);
+    void applyBlocked(QVector<TaskId> ids);
+    void onLoadBatchReady(const TaskTable &batch);
+    void onLoadFinished(bool success, TaskId nextId, const QVector<TaskDependency> &dependencies);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(TaskManager::ChangedFields)
+
 #endif // TASKMANAGER_H
@@ -0,0 +1,108 @@
+#include "TaskScheduler.h"
+#include <QDateTime>
+#include <algorithm>
+#include "TaskTrace.h"
+
+// QTimer takes an int interval; longer waits re-arm on the way
+static constexpr qint64 MAX_WAIT_MS = 24 * 60 * 60 * 1000;
+
+TaskScheduler::TaskScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(this)
+{
+    // Deadlines can be days out, where a coarse timer drifts by hours
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &TaskScheduler::onTimeout);
+}
+
+void TaskScheduler::schedule(TaskId id, Kind kind, qint64 timeMs)
+{
+    const quint64 key = keyOf(id, kind);
+    if (timeMs == 0) {
+        if (m_current.remove(key))
+            arm();
+        return;
+    }
+    if (m_current.value(key) == timeMs)
+        return;
+
+    m_current.insert(key, timeMs);
+    m_heap.append({timeMs, id, kind});
+    std::push_heap(m_heap.begin(), m_heap.end(), later);
+
+    // Only a new earliest deadline moves the timer
+    if (m_heap.first().timeMs == timeMs)
+        arm();
+}
+
+void TaskScheduler::cancel(TaskId id)
+{
+    const bool removed = m_current.remove(keyOf(id, Due)) | m_current.remove(keyOf(id, Reminder));
+    if (removed)
+        arm();
+}
+
+void TaskScheduler::clear()
+{
+    m_heap.clear();
+    m_current.clear();
+    m_timer.stop();
+}
+
+bool TaskScheduler::isLive(const Entry &entry) const
+{
+    const auto it = m_current.constFind(keyOf(entry.id, entry.kind));
+    return it != m_current.cend() && *it == entry.timeMs;
+}
+
+void TaskScheduler::arm()
+{
+    // Rebuild once most of the heap is stale
+    if (m_heap.size() > 2 * m_current.size() + 64) {
+        QVector<Entry> live;
+        live.reserve(m_current.size());
+        for (const Entry &entry : std::as_const(m_heap)) {
+            if (isLive(entry))
+                live.append(entry);
+        }
+        m_heap.swap(live);
+        std::make_heap(m_heap.begin(), m_heap.end(), later);
+    }
+
+    // Drop stale entries from the top so the timer targets a live one
+    while (!m_heap.isEmpty() && !isLive(m_heap.first())) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        m_heap.removeLast();
+    }
+
+    if (m_heap.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+
+    const qint64 wait = m_heap.first().timeMs - QDateTime::currentMSecsSinceEpoch();
+    m_timer.start(int(qBound<qint64>(0, wait, MAX_WAIT_MS)));
+}
+
+void TaskScheduler::onTimeout()
+{
+    TASK_TRACE_SCOPE("TaskScheduler::onTimeout");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // Take everything due first; handlers may schedule again
+    QVector<Entry> due;
+    while (!m_heap.isEmpty() && m_heap.first().timeMs <= now) {
+        const Entry entry = m_heap.first();
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        m_heap.removeLast();
+        if (isLive(entry)) {
+            m_current.remove(keyOf(entry.id, entry.kind));
+            due.append(entry);
+        }
+    }
+
+    arm();
+    for (const Entry &entry : std::as_const(due))
+        emit fired(entry.id, entry.kind);
+}
@@ -0,0 +1,59 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include "Task.h"
+
+// Deadlines for any number of tasks behind a single QTimer. Entries sit in
+// a binary min-heap keyed on time and only the earliest one arms the
+// timer, so scheduling costs O(log n) and an idle board costs nothing.
+//
+// Rescheduling or cancelling leaves the old heap entry in place; it is
+// recognised as stale when it reaches the top, and the heap is rebuilt
+// once stale entries outnumber live ones.
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind : quint8 {
+        Due,
+        Reminder
+    };
+
+    explicit TaskScheduler(QObject *parent = nullptr);
+
+    // Replaces any earlier deadline of this kind for the task; 0 cancels.
+    // A time already past fires on the next event-loop turn.
+    void schedule(TaskId id, Kind kind, qint64 timeMs);
+    void cancel(TaskId id);
+    void clear();
+
+    int size() const { return int(m_current.size()); }
+
+signals:
+    void fired(TaskId id, TaskScheduler::Kind kind);
+
+private:
+    struct Entry {
+        qint64 timeMs;
+        TaskId id;
+        Kind kind;
+    };
+
+    QVector<Entry> m_heap;
+    QHash<quint64, qint64> m_current;  // live deadline per (id, kind)
+    QTimer m_timer;
+
+    static quint64 keyOf(TaskId id, Kind kind) { return (id << 1) | kind; }
+    static bool later(const Entry &a, const Entry &b) { return a.timeMs > b.timeMs; }
+    bool isLive(const Entry &entry) const;
+
+    void arm();
+    void onTimeout();
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,157 @@
+#include "TaskSearchFilterModel.h"
+#include "TaskListModel.h"
+
+TaskSearchFilterModel::TaskSearchFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    connect(this, &QAbstractItemModel::rowsInserted, this, &TaskSearchFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TaskSearchFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &TaskSearchFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &TaskSearchFilterModel::countChanged);
+}
+
+void TaskSearchFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(m_sourceConnections))
+        disconnect(connection);
+    m_sourceConnections.clear();
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    // New and edited tasks may start or stop matching. Rows merely paged in
+    // are filtered against the matches already held, so only a growing
+    // task count asks for a new search.
+    if (sourceModel) {
+        if (TaskListModel *tasks = qobject_cast<TaskListModel *>(sourceModel)) {
+            m_sourceCount = tasks->count();
+            m_sourceConnections << connect(tasks, &TaskListModel::countChanged, this, [this, tasks]() {
+                const int count = tasks->count();
+                const bool grew = count > m_sourceCount;
+                m_sourceCount = count;
+                if (grew)
+                    refreshMatches();
+            });
+        }
+        m_sourceConnections << connect(sourceModel, &QAbstractItemModel::modelReset,
+                                       this, &TaskSearchFilterModel::refreshMatches);
+        m_sourceConnections << connect(sourceModel, &QAbstractItemModel::dataChanged, this,
+                                       [this](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+                                           if (roles.isEmpty()
+                                               || roles.contains(TaskListModel::TaskNameRole)
+                                               || roles.contains(TaskListModel::TaskDescriptionRole)) {
+                                               refreshMatches();
+                                           }
+                                       });
+        // A move or removal can drop a match out of the exposed rows; page
+        // it back in once the source has finished announcing the change
+        auto reexpose = [this]() {
+            QMetaObject::invokeMethod(this, &TaskSearchFilterModel::exposeMatches, Qt::QueuedConnection);
+        };
+        m_sourceConnections << connect(sourceModel, &QAbstractItemModel::layoutChanged, this, reexpose);
+        m_sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, reexpose);
+        if (TaskListModel *tasks = qobject_cast<TaskListModel *>(sourceModel)) {
+            m_sourceConnections << connect(tasks, &TaskListModel::searchFinished,
+                                           this, &TaskSearchFilterModel::onSearchFinished);
+        }
+    }
+    refreshMatches();
+}
+
+bool TaskSearchFilterModel::canFetchMore(const QModelIndex &parent) const
+{
+    // While a query applies, every match is already paged in (or will be
+    // once its search returns); further source pages hold none
+    if (isFiltering())
+        return false;
+    return QSortFilterProxyModel::canFetchMore(parent);
+}
+
+void TaskSearchFilterModel::fetchMore(const QModelIndex &parent)
+{
+    if (!isFiltering())
+        QSortFilterProxyModel::fetchMore(parent);
+}
+
+bool TaskSearchFilterModel::isFiltering() const
+{
+    return m_active || !m_query.trimmed().isEmpty();
+}
+
+void TaskSearchFilterModel::setQuery(const QString &query)
+{
+    if (m_query == query)
+        return;
+
+    m_query = query;
+    refreshMatches();
+    emit queryChanged();
+}
+
+void TaskSearchFilterModel::refreshMatches()
+{
+    // Rows paged in for the current matches need no new search
+    if (m_exposing)
+        return;
+
+    const bool active = !m_query.trimmed().isEmpty();
+    if (!active && !m_active)
+        return;     // Nothing was filtered and nothing is now
+
+    TaskListModel *tasks = qobject_cast<TaskListModel *>(sourceModel());
+    if (!active || !tasks) {
+        m_matches.clear();
+        m_active = false;
+        invalidateRowsFilter();
+        return;
+    }
+
+    // One search in flight at a time; changes meanwhile ask for one more
+    if (m_searching) {
+        m_searchAgain = true;
+        return;
+    }
+    m_searching = true;
+    tasks->search(m_query);
+}
+
+void TaskSearchFilterModel::onSearchFinished(const QString &query, const QVector<TaskId> &taskIds)
+{
+    m_searching = false;
+    if (m_searchAgain || query != m_query) {
+        m_searchAgain = false;
+        refreshMatches();
+        return;
+    }
+
+    m_matches = QSet<TaskId>(taskIds.cbegin(), taskIds.cend());
+    m_active = true;
+    exposeMatches();
+    invalidateRowsFilter();
+}
+
+void TaskSearchFilterModel::exposeMatches()
+{
+    TaskListModel *tasks = qobject_cast<TaskListModel *>(sourceModel());
+    if (!m_active || !tasks || m_exposing || !tasks->canFetchMore(QModelIndex()))
+        return;
+
+    // Matches can sit anywhere in the table; page in just as far as the last
+    int last = -1;
+    for (TaskId id : std::as_const(m_matches))
+        last = qMax(last, tasks->tasks().rowOf(id));
+    if (last < tasks->rowCount())
+        return;
+
+    m_exposing = true;
+    tasks->fetchThrough(last);
+    m_exposing = false;
+}
+
+bool TaskSearchFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!m_active)
+        return true;
+
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+    return m_matches.contains(idx.data(TaskListModel::TaskIdRole).value<TaskId>());
+}
@@ -0,0 +1,58 @@
+#ifndef TASKSEARCHFILTERMODEL_H
+#define TASKSEARCHFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QSet>
+#include <QtQml/qqmlregistration.h>
+#include "Task.h"
+
+// Rows of a TaskListModel whose name or description contains `query`.
+// Matches come from TaskManager's search index once per keystroke, so
+// filtering a row is a hash lookup rather than a string comparison. The
+// search runs on the engine's worker thread; until its result arrives the
+// previous matches stay applied. The source is paged in only as far as the
+// last match, not in full.
+class TaskSearchFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit TaskSearchFilterModel(QObject *parent = nullptr);
+
+    QString query() const { return m_query; }
+    void setQuery(const QString &query);
+
+    int count() const { return rowCount(); }
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+signals:
+    void queryChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QString m_query;
+    bool m_active = false;          // a non-empty query is applied
+    QSet<TaskId> m_matches;
+    QList<QMetaObject::Connection> m_sourceConnections;
+    bool m_searching = false;       // a search is in flight
+    bool m_searchAgain = false;     // matches went stale while it ran
+    bool m_exposing = false;        // paging in rows for the matches
+    int m_sourceCount = 0;          // tasks in the source at the last look
+
+    bool isFiltering() const;
+
+    void refreshMatches();
+    void exposeMatches();
+    void onSearchFinished(const QString &query, const QVector<TaskId> &taskIds);
+};
+
+#endif // TASKSEARCHFILTERMODEL_H
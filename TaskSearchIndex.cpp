@@ -0,0 +1,58 @@
+#include "TaskSearchIndex.h"
+#include <QVector>
+#include <algorithm>
+
+QSet<TaskSearchIndex::Trigram> TaskSearchIndex::trigramsOf(const QString &text)
+{
+    QSet<Trigram> trigrams;
+    const QString folded = text.toCaseFolded();
+    const QChar *chars = folded.constData();
+    for (qsizetype i = 0; i + 2 < folded.size(); ++i) {
+        trigrams.insert(Trigram(chars[i].unicode()) << 32
+                        | Trigram(chars[i + 1].unicode()) << 16
+                        | Trigram(chars[i + 2].unicode()));
+    }
+    return trigrams;
+}
+
+void TaskSearchIndex::add(TaskId id, const QString &name, const QString &description)
+{
+    const QSet<Trigram> trigrams = trigramsOf(name) + trigramsOf(description);
+    for (Trigram trigram : trigrams)
+        m_postings[trigram].insert(id);
+}
+
+void TaskSearchIndex::remove(TaskId id, const QString &name, const QString &description)
+{
+    const QSet<Trigram> trigrams = trigramsOf(name) + trigramsOf(description);
+    for (Trigram trigram : trigrams) {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end())
+            continue;
+        it->remove(id);
+        if (it->isEmpty())
+            m_postings.erase(it);
+    }
+}
+
+QSet<TaskId> TaskSearchIndex::candidates(const QString &query) const
+{
+    Q_ASSERT(canIndex(query));
+
+    // Intersect starting from the rarest trigram so the working set stays small
+    QVector<const QSet<TaskId> *> lists;
+    for (Trigram trigram : trigramsOf(query)) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.cend())
+            return {};
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QSet<TaskId> *a, const QSet<TaskId> *b) {
+        return a->size() < b->size();
+    });
+
+    QSet<TaskId> result = *lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i)
+        result.intersect(*lists.at(i));
+    return result;
+}
@@ -0,0 +1,37 @@
+#ifndef TASKSEARCHINDEX_H
+#define TASKSEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include "Task.h"
+
+// Case-insensitive trigram index over task names and descriptions. Each
+// trigram maps to the IDs of tasks whose text contains it; a query's
+// candidates are the intersection of its trigrams' postings. Candidates
+// can include false positives (trigrams in the wrong order or split across
+// name and description), so callers verify them against the text.
+class TaskSearchIndex
+{
+public:
+    void clear() { m_postings.clear(); }
+
+    void add(TaskId id, const QString &name, const QString &description);
+    void remove(TaskId id, const QString &name, const QString &description);
+
+    // True when query is long enough to be answered from the index;
+    // shorter queries need a scan
+    static bool canIndex(const QString &query) { return query.size() >= 3; }
+
+    // Tasks that contain every trigram of query. Requires canIndex(query).
+    QSet<TaskId> candidates(const QString &query) const;
+
+private:
+    using Trigram = quint64;    // three case-folded UTF-16 units
+
+    QHash<Trigram, QSet<TaskId>> m_postings;
+
+    static QSet<Trigram> trigramsOf(const QString &text);
+};
+
+#endif // TASKSEARCHINDEX_H
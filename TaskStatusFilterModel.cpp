@@ -0,0 +1,109 @@
+#include "TaskStatusFilterModel.h"
+#include "TaskListModel.h"
+#include <limits>
+
+TaskStatusFilterModel::TaskStatusFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    // Only status changes can move a row in or out of the filter
+    setFilterRole(TaskListModel::TaskStatusRole);
+    setDynamicSortFilter(true);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &TaskStatusFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TaskStatusFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &TaskStatusFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &TaskStatusFilterModel::countChanged);
+
+    // Rows leaving the filter may take it below a page
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TaskStatusFilterModel::scheduleTopUp);
+}
+
+void TaskStatusFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(m_sourceConnections))
+        disconnect(connection);
+    m_sourceConnections.clear();
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    // A source page that brought no matches inserts nothing here, so watch
+    // the source itself
+    if (sourceModel) {
+        m_sourceConnections = {
+            connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &TaskStatusFilterModel::scheduleTopUp),
+            connect(sourceModel, &QAbstractItemModel::modelReset, this, &TaskStatusFilterModel::scheduleTopUp),
+        };
+    }
+    scheduleTopUp();
+}
+
+bool TaskStatusFilterModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && sourceModel() && rowCount() < matchingTotal()
+           && sourceModel()->canFetchMore(QModelIndex());
+}
+
+void TaskStatusFilterModel::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid())
+        fetchMatches(rowCount() + TaskListModel::PageSize);
+}
+
+int TaskStatusFilterModel::matchingTotal() const
+{
+    // Through other proxies (a search filter) the table's count is an upper
+    // bound; such a proxy stops offering pages once it has what it needs
+    const QAbstractItemModel *source = sourceModel();
+    while (const auto *proxy = qobject_cast<const QAbstractProxyModel *>(source))
+        source = proxy->sourceModel();
+    const auto *tasks = qobject_cast<const TaskListModel *>(source);
+    if (!tasks)
+        return std::numeric_limits<int>::max();
+    if (m_status < 0)
+        return tasks->count();
+    return m_status <= COMPLETED ? tasks->tasks().statusCount(TaskStatus(m_status)) : 0;
+}
+
+void TaskStatusFilterModel::fetchMatches(int wanted)
+{
+    QAbstractItemModel *source = sourceModel();
+    if (!source)
+        return;
+
+    // Each source page is filtered as it is inserted
+    const int target = qMin(wanted, matchingTotal());
+    while (rowCount() < target && source->canFetchMore(QModelIndex()))
+        source->fetchMore(QModelIndex());
+}
+
+void TaskStatusFilterModel::scheduleTopUp()
+{
+    // Deferred: these fire while the source is still inserting or resetting
+    if (m_topUpScheduled)
+        return;
+    m_topUpScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_topUpScheduled = false;
+        fetchMatches(TaskListModel::PageSize);
+    }, Qt::QueuedConnection);
+}
+
+void TaskStatusFilterModel::setStatus(int status)
+{
+    if (m_status == status)
+        return;
+
+    m_status = status;
+    invalidateRowsFilter();
+    emit statusChanged();
+    scheduleTopUp();
+}
+
+bool TaskStatusFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_status < 0)
+        return true;
+
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+    return idx.data(TaskListModel::TaskStatusRole).toInt() == m_status;
+}
@@ -0,0 +1,53 @@
+#ifndef TASKSTATUSFILTERMODEL_H
+#define TASKSTATUSFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QList>
+#include <QtQml/qqmlregistration.h>
+
+// Rows of a TaskListModel whose status matches `status` (-1 = all).
+// Filtering is keyed on TaskStatusRole, so a status change inserts or
+// removes just that row here instead of rebuilding the whole view.
+//
+// The source pages its rows in, and a status that is rare near the top
+// could leave a page of it without a single match. So the filter pages on
+// its own terms: it pulls source pages until it holds a page of matches,
+// or every task with the status, or the source runs out.
+class TaskStatusFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(int status READ status WRITE setStatus NOTIFY statusChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit TaskStatusFilterModel(QObject *parent = nullptr);
+
+    int status() const { return m_status; }
+    void setStatus(int status);
+
+    int count() const { return rowCount(); }
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+signals:
+    void statusChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    int m_status = -1;
+    QList<QMetaObject::Connection> m_sourceConnections;
+    bool m_topUpScheduled = false;
+
+    // Tasks with the status in the whole source, exposed or not
+    int matchingTotal() const;
+    void fetchMatches(int wanted);
+    void scheduleTopUp();
+};
+
+#endif // TASKSTATUSFILTERMODEL_H
@@ -1,97 +1,1688 @@
 #include "TaskStore.h"
 #include "Task.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSet>
+#include <QPromise>
 #include <QDataStream>
-#include <QDebug>
+#include <QtEndian>
+#include <QThreadPool>
+#include <QMutex>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtConcurrent/QtConcurrentMap>
+#include "Crc32c.h"
+#include "TaskLogging.h"
+#include "TaskTrace.h"
 
 static constexpr quint32 MAGIC = 0x54534B46; // "TSKF"
-static constexpr quint16 VERSION = 1;
+static constexpr quint16 VERSION = 6;        // newest version this build reads
+static constexpr quint16 POOLED_VERSION = 6; // v6: fixed-size records referring into one string section
+static constexpr quint16 SCHEDULE_VERSION = 5; // v5: v4 with due and reminder columns
+static constexpr quint16 BLOCK_VERSION = 4;  // v4: compressed, checksummed blocks of rows
+static constexpr quint16 MAPPED_VERSION = 3; // v3: fixed-size records, loaded through a memory map
+static constexpr quint16 MIN_VERSION = 1;    // v1/v2: QDataStream, one length-prefixed blob per task
 
-TaskStore::TaskStore(QObject *parent) : QObject(parent) {}
+// v3 layout. Every version starts with the big-endian magic and version
+// written by QDataStream, so the header keeps those two fields big-endian;
+// everything after them is little-endian. Records are 8-byte aligned and
+// read in place from the mapping.
+struct DiskHeader {
+    quint32_be magic;
+    quint16_be version;
+    quint16_le headerSize;
+    quint32_le recordSize;
+    quint32_le count;
+    quint64_le nextId;
+    quint64_le reserved;
+};
 
-bool TaskStore::save(const QVector<Task*> &tasks, const QString &filePath)
+struct DiskRecord {
+    quint64_le id;
+    qint64_le createdMs;
+    qint64_le completedMs;      // 0 when not completed
+    quint8 status;
+    quint8 priority;
+    char name[33];              // NUL-terminated UTF-8, same limits as Task
+    char description[256];
+    char reserved[5];
+};
+
+// Follows each v3 record written by builds that know due dates, as
+// announced by the larger recordSize; older readers skip it
+struct DiskSchedule {
+    qint64_le dueMs;            // 0 when not set
+    qint64_le reminderMs;
+};
+
+struct DiskScheduledRecord {
+    DiskRecord record;
+    DiskSchedule schedule;
+};
+
+// v6 layout: the v3 header, with reserved holding the size of the string
+// section, then count records, then the section itself: the UTF-8 text of
+// every record back to back, each distinct string once. A record refers to
+// its text by offset and length within the section, so text has no length
+// limit and the records stay small and fixed-size.
+struct PooledRecord {
+    quint64_le id;
+    qint64_le createdMs;
+    qint64_le completedMs;      // 0 when not completed
+    qint64_le dueMs;            // 0 when not set
+    qint64_le reminderMs;       // 0 when not set
+    quint32_le nameOffset;
+    quint32_le nameLength;
+    quint32_le descriptionOffset;
+    quint32_le descriptionLength;
+    quint8 status;
+    quint8 priority;
+    char reserved[6];
+};
+
+static_assert(sizeof(DiskHeader) == 32, "DiskHeader layout changed");
+static_assert(sizeof(DiskRecord) == 320, "DiskRecord layout changed");
+static_assert(sizeof(DiskScheduledRecord) == 336, "DiskScheduledRecord layout changed");
+static_assert(alignof(DiskRecord) <= sizeof(DiskHeader), "records must stay aligned after the header");
+static_assert(sizeof(PooledRecord) == 64, "PooledRecord layout changed");
+
+// v4/v5 layout: a header, then blocks of up to BLOCK_ROWS rows. Each block is
+// a BlockHeader followed by the qCompress()ed columns of its rows. Both
+// the block header and the payload carry a CRC-32C; a block that fails
+// either is skipped on load, and a damaged block header is stepped over by
+// scanning for the next block magic.
+struct BlockFileHeader {
+    quint32_be magic;
+    quint16_be version;
+    quint16_le headerSize;
+    quint32_le blockRows;
+    quint32_le count;
+    quint64_le nextId;
+    quint32_le headerCrc;       // CRC-32C of the fields above
+    quint32_le reserved;
+};
+
+struct BlockHeader {
+    quint32_le magic;
+    quint32_le rows;
+    quint32_le rawSize;         // payload size after decompression
+    quint32_le storedSize;      // payload size in the file
+    quint32_le payloadCrc;      // CRC-32C of the stored payload
+    quint32_le headerCrc;       // CRC-32C of the fields above
+};
+
+// Uncompressed block payload, little-endian columns of n rows:
+//   id[n] u64, createdMs[n] i64, completedMs[n] i64,
+//   (v5) dueMs[n] i64, reminderMs[n] i64,
+//   status[n] u8, priority[n] u8, nameLength[n] u32, descriptionLength[n] u32,
+//   then all name bytes, then all description bytes (UTF-8).
+// Grouping like values compresses far better than whole records.
+// Column offsets within a block payload of n rows
+struct BlockLayout {
+    qsizetype created, completed, due, reminder, status, priority, nameLengths, descLengths, text;
+
+    BlockLayout(int n, bool scheduled)
+    {
+        created = n * sizeof(quint64);
+        completed = created + n * sizeof(qint64);
+        due = completed + n * sizeof(qint64);
+        reminder = due + (scheduled ? n * sizeof(qint64) : 0);
+        status = reminder + (scheduled ? n * sizeof(qint64) : 0);
+        priority = status + n;
+        nameLengths = priority + n;
+        descLengths = nameLengths + n * sizeof(quint32);
+        text = descLengths + n * sizeof(quint32);
+    }
+};
+
+static_assert(sizeof(BlockFileHeader) == 32, "BlockFileHeader layout changed");
+static_assert(sizeof(BlockHeader) == 24, "BlockHeader layout changed");
+
+static constexpr quint32 BLOCK_MAGIC = 0x54534B42; // "TSKB"
+static constexpr int BLOCK_ROWS = 4096;
+
+// Dependency section, appended to a v3 or newer file when there are any:
+// count (blocker, blocked) pairs of little-endian u64 task IDs, then this
+// footer as the last bytes of the file, where readers look for it. Builds
+// that predate it ignore the trailing bytes (the block reader skips them
+// as damaged), so their files stay readable both ways.
+struct DependencyFooter {
+    quint64_le offset;          // where the pairs start
+    quint32_le count;
+    quint32_le crc;             // CRC-32C of the pairs
+    quint32_le reserved;
+    quint32_le magic;           // DEPENDENCY_MAGIC
+};
+
+static_assert(sizeof(DependencyFooter) == 24, "DependencyFooter layout changed");
+
+static constexpr quint32 DEPENDENCY_MAGIC = 0x54534B44; // "TSKD"
+static constexpr qint64 DEPENDENCY_PAIR_BYTES = 2 * sizeof(quint64);
+
+static constexpr int WRITE_BATCH = 1024;     // records per write() call
+static constexpr int LOAD_BATCH = 2048;      // rows per loadBatchReady() during loadAsync()
+static constexpr int ID_BLOCK = 64;          // IDs reserved at a time when shared
+static constexpr qint64 STAMP_RETENTION_MS = 10 * 60 * 1000;   // stamps kept past a compaction, when shared
+
+// Size and modification time; a change means someone rewrote the snapshot
+static QPair<qint64, qint64> snapshotVersion(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists())
+        return {-1, 0};
+    return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+}
+
+// The ID counter from the header, without reading the rows; 0 when the
+// file is missing or predates fixed headers (v1/v2)
+static TaskId snapshotNextId(const QString &filePath)
 {
     QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    // v3 and the block formats keep it at the same offset
+    static_assert(offsetof(BlockFileHeader, nextId) == offsetof(DiskHeader, nextId));
+    const QByteArray head = file.read(offsetof(DiskHeader, nextId) + sizeof(quint64));
+    if (head.size() < qsizetype(offsetof(DiskHeader, nextId) + sizeof(quint64))
+        || qFromBigEndian<quint32>(head.constData()) != MAGIC
+        || qFromBigEndian<quint16>(head.constData() + sizeof(quint32)) < MAPPED_VERSION)
+        return 0;
+    return qFromLittleEndian<quint64>(head.constData() + offsetof(DiskHeader, nextId));
+}
+
+// The first ID past the ones a journal record takes
+static TaskId idsTakenBy(const TaskJournal::Record &record)
+{
+    if (record.op == TaskJournal::AddOp)
+        return record.id + 1;
+    if (record.op == TaskJournal::ReserveOp)
+        return record.id;
+    return 0;
+}
+
+static QString readField(const char *src, int capacity)
+{
+    return QString::fromUtf8(src, qstrnlen(src, capacity));
+}
+
+// Blocks are compressed and decompressed this many at a time in parallel
+static int blockWave()
+{
+    return qMax(1, QThreadPool::globalInstance()->maxThreadCount()) * 2;
+}
+
+// Encodes rows [first, first + n) as one block, header included
+static QByteArray packBlock(const TaskTable &tasks, int first, int n)
+{
+    QVector<QByteArray> names(n), descriptions(n);
+    qsizetype textBytes = 0;
+    for (int i = 0; i < n; ++i) {
+        names[i] = tasks.nameUtf8(first + i).toByteArray();
+        descriptions[i] = tasks.descriptionUtf8(first + i);
+        textBytes += names[i].size() + descriptions[i].size();
+    }
+
+    const BlockLayout layout(n, true);
+    QByteArray raw(layout.text + textBytes, Qt::Uninitialized);
+    char *ids = raw.data();
+    char *created = ids + layout.created;
+    char *completed = ids + layout.completed;
+    char *due = ids + layout.due;
+    char *reminder = ids + layout.reminder;
+    char *status = ids + layout.status;
+    char *priority = ids + layout.priority;
+    char *nameLengths = ids + layout.nameLengths;
+    char *descLengths = ids + layout.descLengths;
+    char *text = ids + layout.text;
+
+    for (int i = 0; i < n; ++i) {
+        const int row = first + i;
+        qToLittleEndian<quint64>(tasks.id(row), ids + i * sizeof(quint64));
+        qToLittleEndian<qint64>(tasks.createdMs(row), created + i * sizeof(qint64));
+        qToLittleEndian<qint64>(tasks.completedMs(row), completed + i * sizeof(qint64));
+        qToLittleEndian<qint64>(tasks.dueMs(row), due + i * sizeof(qint64));
+        qToLittleEndian<qint64>(tasks.reminderMs(row), reminder + i * sizeof(qint64));
+        status[i] = char(tasks.status(row));
+        priority[i] = char(tasks.priority(row));
+        qToLittleEndian<quint32>(quint32(names[i].size()), nameLengths + i * sizeof(quint32));
+        qToLittleEndian<quint32>(quint32(descriptions[i].size()), descLengths + i * sizeof(quint32));
+    }
+    for (const QByteArray &name : std::as_const(names)) {
+        std::memcpy(text, name.constData(), name.size());
+        text += name.size();
+    }
+    for (const QByteArray &description : std::as_const(descriptions)) {
+        std::memcpy(text, description.constData(), description.size());
+        text += description.size();
+    }
+
+    const QByteArray stored = qCompress(raw);
+
+    BlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.rows = quint32(n);
+    header.rawSize = quint32(raw.size());
+    header.storedSize = quint32(stored.size());
+    header.payloadCrc = crc32c(stored.constData(), stored.size());
+    header.headerCrc = crc32c(&header, offsetof(BlockHeader, headerCrc));
+
+    QByteArray block;
+    block.reserve(sizeof(header) + stored.size());
+    block.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    block.append(stored);
+    return block;
+}
+
+namespace {
+
+// Descriptions of loaded blocks, decoded on demand. Holds each block's
+// compressed payload (a fraction of the decoded text) and keeps the last
+// few decompressed blocks, so reading the descriptions of neighbouring
+// rows, as a list view does, decompresses each block once.
+class BlockTextSource : public TaskTextSource
+{
+public:
+    // Takes a copy of a block's stored payload; returns the text index of
+    // its first row
+    quint32 addBlock(const char *stored, quint32 storedSize, quint32 rawSize, quint32 rows, bool scheduled)
+    {
+        QMutexLocker locker(&m_mutex);
+        const quint32 first = m_blocks.isEmpty() ? 0 : m_blocks.last().first + m_blocks.last().rows;
+        m_blocks.append({QByteArray(stored, storedSize), rawSize, rows, first, scheduled});
+        return first;
+    }
+
+    QString text(quint32 index) const override
+    {
+        TASK_TRACE_SCOPE("BlockTextSource::text");
+
+        QMutexLocker locker(&m_mutex);
+        const auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), index,
+                                         [](quint32 value, const Block &block) { return value < block.first; });
+        if (it == m_blocks.cbegin())
+            return QString();
+        const int blockIndex = int(std::prev(it) - m_blocks.cbegin());
+        const Block block = *std::prev(it);
+        const quint32 slot = index - block.first;
+        if (slot >= block.rows)
+            return QString();
+
+        std::shared_ptr<const Decoded> decoded = cached(blockIndex);
+        if (!decoded) {
+            // Decompress without the lock so other readers are not held up
+            locker.unlock();
+            decoded = decode(block);
+            locker.relock();
+            if (!decoded)
+                return QString();
+            remember(blockIndex, decoded);
+        }
+
+        const quint32 begin = decoded->offsets.at(slot);
+        return QString::fromUtf8(decoded->raw.constData() + begin, decoded->offsets.at(slot + 1) - begin);
+    }
+
+private:
+    struct Block {
+        QByteArray stored;
+        quint32 rawSize;
+        quint32 rows;
+        quint32 first;
+        bool scheduled;         // v5 layout
+    };
+
+    struct Decoded {
+        QByteArray raw;
+        QVector<quint32> offsets;   // of each description in raw, plus the end
+    };
+
+    static constexpr int CacheSize = 8;
+
+    mutable QMutex m_mutex;
+    QVector<Block> m_blocks;
+    mutable QVector<QPair<int, std::shared_ptr<const Decoded>>> m_cache;  // most recent first
+
+    std::shared_ptr<const Decoded> cached(int blockIndex) const
+    {
+        for (int i = 0; i < m_cache.size(); ++i) {
+            if (m_cache.at(i).first == blockIndex) {
+                if (i > 0)
+                    m_cache.move(i, 0);
+                return m_cache.first().second;
+            }
+        }
+        return nullptr;
+    }
+
+    void remember(int blockIndex, const std::shared_ptr<const Decoded> &decoded) const
+    {
+        if (cached(blockIndex))
+            return;     // another reader got there first
+        m_cache.prepend({blockIndex, decoded});
+        if (m_cache.size() > CacheSize)
+            m_cache.removeLast();
+    }
+
+    // Layout as written by packBlock(); validated when the block was loaded
+    static std::shared_ptr<const Decoded> decode(const Block &block)
+    {
+        auto decoded = std::make_shared<Decoded>();
+        decoded->raw = qUncompress(reinterpret_cast<const uchar *>(block.stored.constData()),
+                                   block.stored.size());
+        if (decoded->raw.size() != qsizetype(block.rawSize))
+            return nullptr;
+
+        const int n = int(block.rows);
+        const BlockLayout layout(n, block.scheduled);
+        const char *nameLengths = decoded->raw.constData() + layout.nameLengths;
+        const char *descLengths = decoded->raw.constData() + layout.descLengths;
+
+        quint32 offset = quint32(layout.text);
+        for (int i = 0; i < n; ++i)
+            offset += qFromLittleEndian<quint32>(nameLengths + i * sizeof(quint32));
+
+        decoded->offsets.reserve(n + 1);
+        for (int i = 0; i < n; ++i) {
+            decoded->offsets.append(offset);
+            offset += qFromLittleEndian<quint32>(descLengths + i * sizeof(quint32));
+        }
+        decoded->offsets.append(offset);
+        return decoded;
+    }
+};
+
+} // namespace
+
+// Appends the rows of a decompressed block to batch. The whole block is
+// validated first, so a bad one adds nothing. With a text source, the
+// descriptions are left in the block's stored payload and decoded on
+// first use.
+static bool unpackBlock(const QByteArray &raw, const QByteArray &stored, int n, bool scheduled,
+                        TaskTable &batch, const std::shared_ptr<BlockTextSource> &source)
+{
+    const BlockLayout layout(n, scheduled);
+    const qsizetype fixedBytes = layout.text;
+    if (raw.size() < fixedBytes)
+        return false;
+
+    const char *ids = raw.constData();
+    const char *created = ids + layout.created;
+    const char *completed = ids + layout.completed;
+    const char *due = ids + layout.due;
+    const char *reminder = ids + layout.reminder;
+    const char *status = ids + layout.status;
+    const char *priority = ids + layout.priority;
+    const char *nameLengths = ids + layout.nameLengths;
+    const char *descLengths = ids + layout.descLengths;
+    const char *text = ids + layout.text;
+
+    // v4 blocks have no schedule columns
+    auto dueAt = [&](int i) { return scheduled ? qFromLittleEndian<qint64>(due + i * sizeof(qint64)) : 0; };
+    auto reminderAt = [&](int i) {
+        return scheduled ? qFromLittleEndian<qint64>(reminder + i * sizeof(qint64)) : 0;
+    };
+
+    qsizetype nameBytes = 0;
+    qsizetype descBytes = 0;
+    for (int i = 0; i < n; ++i) {
+        if (quint8(status[i]) > COMPLETED || quint8(priority[i]) > HIGH)
+            return false;
+        nameBytes += qFromLittleEndian<quint32>(nameLengths + i * sizeof(quint32));
+        descBytes += qFromLittleEndian<quint32>(descLengths + i * sizeof(quint32));
+    }
+    if (fixedBytes + nameBytes + descBytes != raw.size())
+        return false;
+
+    const char *name = text;
+    if (source) {
+        const quint32 firstIndex = source->addBlock(stored.constData(), quint32(stored.size()),
+                                                    quint32(raw.size()), quint32(n), scheduled);
+        const std::shared_ptr<const TaskTextSource> textSource = source;
+        for (int i = 0; i < n; ++i) {
+            const quint32 nameLength = qFromLittleEndian<quint32>(nameLengths + i * sizeof(quint32));
+            batch.appendDeferred(qFromLittleEndian<quint64>(ids + i * sizeof(quint64)),
+                                 static_cast<TaskStatus>(status[i]),
+                                 static_cast<TaskPriority>(priority[i]),
+                                 qFromLittleEndian<qint64>(created + i * sizeof(qint64)),
+                                 qFromLittleEndian<qint64>(completed + i * sizeof(qint64)),
+                                 QByteArrayView(name, nameLength),
+                                 textSource, firstIndex + quint32(i), dueAt(i), reminderAt(i));
+            name += nameLength;
+        }
+        return true;
+    }
+
+    const char *description = text + nameBytes;
+    for (int i = 0; i < n; ++i) {
+        const quint32 nameLength = qFromLittleEndian<quint32>(nameLengths + i * sizeof(quint32));
+        const quint32 descLength = qFromLittleEndian<quint32>(descLengths + i * sizeof(quint32));
+        batch.appendUtf8(qFromLittleEndian<quint64>(ids + i * sizeof(quint64)),
+                         static_cast<TaskStatus>(status[i]),
+                         static_cast<TaskPriority>(priority[i]),
+                         qFromLittleEndian<qint64>(created + i * sizeof(qint64)),
+                         qFromLittleEndian<qint64>(completed + i * sizeof(qint64)),
+                         QByteArrayView(name, nameLength),
+                         QByteArrayView(description, descLength),
+                         dueAt(i), reminderAt(i));
+        name += nameLength;
+        description += descLength;
+    }
+    return true;
+}
+
+// Reads the dependency section of a mapped file, if it has one, and returns
+// where the data before it ends
+static qint64 readDependencySection(const char *bytes, qint64 fileSize, QVector<TaskDependency> &out)
+{
+    if (fileSize < qint64(sizeof(DependencyFooter)))
+        return fileSize;
+
+    DependencyFooter footer;
+    std::memcpy(&footer, bytes + fileSize - sizeof(footer), sizeof(footer));
+    if (footer.magic != DEPENDENCY_MAGIC)
+        return fileSize;
+
+    const qint64 end = fileSize - qint64(sizeof(footer));
+    const qint64 offset = qint64(footer.offset);
+    if (offset < 0 || offset > end || end - offset != qint64(footer.count) * DEPENDENCY_PAIR_BYTES) {
+        qCWarning(lcTaskStore) << "TaskStore: Corrupt dependency footer; dependencies dropped";
+        return fileSize;
+    }
+    if (crc32c(bytes + offset, end - offset) != footer.crc) {
+        qCWarning(lcTaskStore) << "TaskStore: Dependency section is corrupt; dependencies dropped";
+        return offset;
+    }
+
+    const char *pair = bytes + offset;
+    out.resize(footer.count);
+    for (TaskDependency &dependency : out) {
+        dependency.blocker = qFromLittleEndian<quint64>(pair);
+        dependency.blocked = qFromLittleEndian<quint64>(pair + sizeof(quint64));
+        pair += DEPENDENCY_PAIR_BYTES;
+    }
+    return offset;
+}
+
+// Replays LinkOp and UnlinkOp records, in journal order
+static void applyLinkRecords(const QVector<TaskJournal::Record> &records, QVector<TaskDependency> &dependencies)
+{
+    if (records.isEmpty())
+        return;
+
+    QSet<TaskDependency> edges(dependencies.cbegin(), dependencies.cend());
+    for (const TaskJournal::Record &record : records) {
+        const TaskDependency dependency{record.blockerId, record.id};
+        if (record.op == TaskJournal::LinkOp)
+            edges.insert(dependency);
+        else
+            edges.remove(dependency);
+    }
+    dependencies = QVector<TaskDependency>(edges.cbegin(), edges.cend());
+}
+
+namespace {
+
+// Net effect of a journal, per task. Records carry absolute values and IDs
+// are never reused, so folding them by ID matches an in-order replay but
+// can be applied to the snapshot one batch at a time.
+struct JournalOverlay
+{
+    struct Entry {
+        bool removed = false;
+        bool hasStatus = false;
+        TaskStatus status = PENDING;
+        qint64 timeMs = 0;
+        bool hasPriority = false;
+        TaskPriority priority = MEDIUM;
+        bool hasText = false;
+        QString name;
+        QString description;
+        bool hasSchedule = false;
+        qint64 dueMs = 0;
+        qint64 reminderMs = 0;
+    };
+
+    QHash<TaskId, Entry> entries;
+    QVector<Task> added;            // journal order
+    QSet<TaskId> notInSnapshot;     // added IDs not yet seen in a batch
+    QVector<TaskJournal::Record> links;     // LinkOp and UnlinkOp, journal order
+    TaskId nextId = 1;
+
+    void add(const TaskJournal::Record &record)
+    {
+        switch (record.op) {
+        case TaskJournal::AddOp:
+            added.append(record.task);
+            notInSnapshot.insert(record.id);
+            nextId = qMax(nextId, record.id + 1);
+            break;
+        case TaskJournal::ReserveOp:
+            nextId = qMax(nextId, record.id);
+            break;
+        case TaskJournal::RemoveOp:
+            entries[record.id].removed = true;
+            break;
+        case TaskJournal::StatusOp: {
+            Entry &entry = entries[record.id];
+            entry.hasStatus = true;
+            entry.status = record.status;
+            entry.timeMs = record.timeMs;
+            break;
+        }
+        case TaskJournal::PriorityOp: {
+            Entry &entry = entries[record.id];
+            entry.hasPriority = true;
+            entry.priority = record.priority;
+            break;
+        }
+        case TaskJournal::EditOp: {
+            Entry &entry = entries[record.id];
+            entry.hasText = true;
+            entry.name = record.task.taskName();
+            entry.description = record.task.taskDescription();
+            break;
+        }
+        case TaskJournal::ScheduleOp: {
+            Entry &entry = entries[record.id];
+            entry.hasSchedule = true;
+            entry.dueMs = record.dueMs;
+            entry.reminderMs = record.reminderMs;
+            break;
+        }
+        case TaskJournal::LinkOp:
+        case TaskJournal::UnlinkOp:
+            links.append(record);
+            break;
+        }
+    }
+
+    void apply(TaskTable &batch)
+    {
+        if (entries.isEmpty() && notInSnapshot.isEmpty())
+            return;
+
+        for (int row = batch.size() - 1; row >= 0; --row) {
+            const TaskId id = batch.id(row);
+            notInSnapshot.remove(id);
+
+            const auto it = entries.constFind(id);
+            if (it == entries.cend())
+                continue;
+            if (it->removed) {
+                batch.removeAt(row);
+                continue;
+            }
+            if (it->hasStatus)
+                batch.setStatus(row, it->status, it->timeMs);
+            if (it->hasPriority)
+                batch.setPriority(row, it->priority);
+            if (it->hasText) {
+                batch.setName(row, it->name);
+                batch.setDescription(row, it->description);
+            }
+            if (it->hasSchedule) {
+                batch.setDueMs(row, it->dueMs);
+                batch.setReminderMs(row, it->reminderMs);
+            }
+        }
+    }
+
+    // Tasks added after the snapshot was written; call after every batch
+    TaskTable takeAdded()
+    {
+        TaskTable tail;
+        for (const Task &task : std::as_const(added)) {
+            if (notInSnapshot.contains(task.taskId()))
+                tail.append(task);
+        }
+        apply(tail);
+        return tail;
+    }
+};
+
+} // namespace
+
+// The watchers are children so they follow the store to another thread
+TaskStore::TaskStore(QObject *parent)
+    : QObject(parent)
+    , m_writer(this)
+    , m_loader(this)
+    , m_origin(QRandomGenerator::global()->generate64() | 1)
+{
+    connect(&m_writer, &QFutureWatcher<bool>::finished, this, &TaskStore::onSaveFinished);
+    connect(&m_loader, &QFutureWatcher<void>::progressValueChanged, this, [this](int loaded) {
+        emit loadProgress(loaded, m_loader.progressMaximum());
+    });
+}
+
+TaskStore::~TaskStore()
+{
+    m_loader.cancel();
+    m_loader.waitForFinished();
+
+    // Let an in-flight write finish, and don't drop a queued one on shutdown
+    m_writer.waitForFinished();
+    if (m_queued)
+        writeFile(m_queued->tasks, m_queued->dependencies, m_queued->nextId, m_queued->filePath,
+                  m_queued->compressed);
+}
+
+bool TaskStore::save(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+                     TaskId nextId, const QString &filePath)
+{
+    TASK_TRACE_SCOPE("TaskStore::save");
+    // The journal records dropped below may hold reservations
+    if (!writeFile(tasks, dependencies, qMax(nextId, m_idFloor), filePath, m_compressionEnabled))
+        return false;
+
+    // The snapshot now holds everything; stale journal records must not be
+    // replayed over it (a logged add could resurrect a since-removed task)
+    discardCovered(coveredJournalBytes(), filePath);
+    return true;
+}
+
+void TaskStore::saveAsync(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+                          TaskId nextId, const QString &filePath)
+{
+    PendingSave request;
+    request.tasks = tasks;
+    request.dependencies = dependencies;
+    request.nextId = qMax(nextId, m_idFloor);
+    request.filePath = filePath;
+    request.compressed = m_compressionEnabled;
+    request.journalOffset = coveredJournalBytes();
+
+    if (isSaving()) {
+        m_queued = std::move(request);
+        return;
+    }
+    startSave(std::move(request));
+}
+
+void TaskStore::startSave(PendingSave request)
+{
+    m_running = std::move(request);
+
+    // The lambda holds its own copy of the columns; they are implicitly
+    // shared, so this costs no task data and later edits detach from it
+    m_writer.setFuture(QtConcurrent::run([tasks = m_running.tasks,
+                                          dependencies = m_running.dependencies,
+                                          nextId = m_running.nextId,
+                                          filePath = m_running.filePath,
+                                          compressed = m_running.compressed]() {
+        return writeFile(tasks, dependencies, nextId, filePath, compressed);
+    }));
+}
+
+void TaskStore::onSaveFinished()
+{
+    const bool success = m_writer.result();
+    if (success) {
+        // Records appended while writing stay; a queued save's offset shifts with them
+        discardCovered(m_running.journalOffset, m_running.filePath);
+        if (m_queued)
+            m_queued->journalOffset = qMax<qint64>(0, m_queued->journalOffset - m_running.journalOffset);
+        qCDebug(lcTaskStore) << "TaskStore: Saved" << m_running.tasks.size() << "tasks to" << m_running.filePath;
+    } else {
+        qCWarning(lcTaskStore) << "TaskStore: Background save failed:" << m_running.filePath;
+    }
+    m_running = PendingSave();
+
+    emit saveFinished(success);
+
+    if (m_queued) {
+        PendingSave next = std::move(*m_queued);
+        m_queued.reset();
+        startSave(std::move(next));
+    }
+}
+
+bool TaskStore::writeFile(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+                          TaskId nextId, const QString &filePath, bool compressed)
+{
+    TASK_TRACE_SCOPE("TaskStore::writeFile");
+    // QSaveFile writes beside the target and renames over it on commit, so
+    // a crash mid-write leaves the previous file intact
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "TaskStore: Cannot open file for writing:" << filePath;
+        qCWarning(lcTaskStore) << "TaskStore: Cannot open file for writing:" << filePath;
+        return false;
+    }
+    const bool written = (compressed ? writeBlocks(tasks, nextId, file)
+                                     : writeSnapshot(tasks, nextId, file))
+                         && writeDependencies(dependencies, file);
+    if (!written) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        qCWarning(lcTaskStore) << "TaskStore: Failed to commit" << filePath << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TaskStore::writeSnapshot(const TaskTable &tasks, TaskId nextId, QIODevice &device)
+{
+    // The string section is built first, since the header announces its
+    // size. Interning into a fresh pool drops text that edits left behind
+    // and stores repeated text once.
+    TaskStringPool strings;
+    std::vector<PooledRecord> records(tasks.size());
+    for (int row = 0; row < tasks.size(); ++row) {
+        PooledRecord &rec = records[row];
+        rec = PooledRecord{};
+        rec.id = tasks.id(row);
+        rec.createdMs = tasks.createdMs(row);
+        rec.completedMs = tasks.completedMs(row);
+        rec.dueMs = tasks.dueMs(row);
+        rec.reminderMs = tasks.reminderMs(row);
+        rec.status = tasks.status(row);
+        rec.priority = tasks.priority(row);
+        const TaskStringPool::Ref name = strings.intern(tasks.nameUtf8(row));
+        const TaskStringPool::Ref description = strings.intern(QByteArrayView(tasks.descriptionUtf8(row)));
+        rec.nameOffset = name.offset;
+        rec.nameLength = name.length;
+        rec.descriptionOffset = description.offset;
+        rec.descriptionLength = description.length;
+    }
+    // Offsets are 32-bit, and an all-ones length is reserved by TaskTable
+    if (strings.size() >= qsizetype(std::numeric_limits<quint32>::max())) {
+        qCWarning(lcTaskStore) << "TaskStore: Task text too large to save";
         return false;
     }
 
-    QDataStream out(&file);
-    out.setVersion(QDataStream::Qt_6_5);
+    DiskHeader header{};
+    header.magic = MAGIC;
+    header.version = POOLED_VERSION;
+    header.headerSize = sizeof(DiskHeader);
+    header.recordSize = sizeof(PooledRecord);
+    header.count = quint32(tasks.size());
+    header.nextId = nextId;
+    header.reserved = quint64(strings.size());
 
-    out << MAGIC << VERSION << quint32(tasks.size());
+    if (device.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        qCWarning(lcTaskStore) << "TaskStore: Failed to write header";
+        return false;
+    }
 
-    for (Task *t : tasks) {
-        if (!writeTask(out, t)) {
-            qWarning() << "TaskStore: Failed to write task";
+    for (int first = 0; first < tasks.size(); first += WRITE_BATCH) {
+        const qint64 bytes = qint64(qMin(WRITE_BATCH, tasks.size() - first)) * sizeof(PooledRecord);
+        if (device.write(reinterpret_cast<const char *>(records.data() + first), bytes) != bytes) {
+            qCWarning(lcTaskStore) << "TaskStore: Failed to write task";
             return false;
         }
     }
 
+    if (device.write(strings.bytes()) != strings.size()) {
+        qCWarning(lcTaskStore) << "TaskStore: Failed to write task text";
+        return false;
+    }
+    return true;
+}
+
+bool TaskStore::writeBlocks(const TaskTable &tasks, TaskId nextId, QIODevice &device)
+{
+    BlockFileHeader header{};
+    header.magic = MAGIC;
+    header.version = SCHEDULE_VERSION;
+    header.headerSize = sizeof(BlockFileHeader);
+    header.blockRows = BLOCK_ROWS;
+    header.count = quint32(tasks.size());
+    header.nextId = nextId;
+    header.headerCrc = crc32c(&header, offsetof(BlockFileHeader, headerCrc));
+
+    if (device.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        qCWarning(lcTaskStore) << "TaskStore: Failed to write header";
+        return false;
+    }
+
+    // Compression dominates, so blocks are packed in parallel a wave at a
+    // time and written in order
+    const int wave = blockWave();
+    QVector<int> starts;
+    for (int first = 0; first < tasks.size(); first += BLOCK_ROWS * wave) {
+        starts.clear();
+        for (int i = 0; i < wave && first + i * BLOCK_ROWS < tasks.size(); ++i)
+            starts.append(first + i * BLOCK_ROWS);
+
+        const QVector<QByteArray> blocks = QtConcurrent::blockingMapped<QVector<QByteArray>>(
+            starts, [&tasks](int start) {
+                return packBlock(tasks, start, qMin(BLOCK_ROWS, tasks.size() - start));
+            });
+        for (const QByteArray &block : blocks) {
+            if (device.write(block) != block.size()) {
+                qCWarning(lcTaskStore) << "TaskStore: Failed to write block";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TaskStore::writeDependencies(const QVector<TaskDependency> &dependencies, QIODevice &device)
+{
+    // Files without dependencies stay exactly as before
+    if (dependencies.isEmpty())
+        return true;
+
+    QByteArray pairs(dependencies.size() * DEPENDENCY_PAIR_BYTES, Qt::Uninitialized);
+    char *pair = pairs.data();
+    for (const TaskDependency &dependency : dependencies) {
+        qToLittleEndian<quint64>(dependency.blocker, pair);
+        qToLittleEndian<quint64>(dependency.blocked, pair + sizeof(quint64));
+        pair += DEPENDENCY_PAIR_BYTES;
+    }
+
+    DependencyFooter footer{};
+    footer.offset = quint64(device.pos());
+    footer.count = quint32(dependencies.size());
+    footer.crc = crc32c(pairs.constData(), pairs.size());
+    footer.magic = DEPENDENCY_MAGIC;
+
+    if (device.write(pairs) != pairs.size()
+        || device.write(reinterpret_cast<const char *>(&footer), sizeof(footer)) != qint64(sizeof(footer))) {
+        qCWarning(lcTaskStore) << "TaskStore: Failed to write dependencies";
+        return false;
+    }
     return true;
 }
 
 // NEW IMPLEMENTATION: returns bool, fills outTasks
-bool TaskStore::load(const QString &filePath, QVector<Task*> &outTasks, QObject *taskParent)
+bool TaskStore::load(const QString &filePath, TaskTable &outTasks,
+                     QVector<TaskDependency> &outDependencies, TaskId &outNextId)
 {
+    TASK_TRACE_SCOPE("TaskStore::load");
     outTasks.clear(); // Always start clean
+    outDependencies.clear();
+    outNextId = 1;
+    const QPair<qint64, qint64> version = snapshotVersion(filePath);
+
+    // A single batch covering the whole file becomes the result as-is
+    auto takeAll = [&outTasks](TaskTable &batch, int, int) {
+        outTasks = std::move(batch);
+        return true;
+    };
 
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    if (file.open(QIODevice::ReadOnly) && !readSnapshot(file, INT_MAX, takeAll, outNextId, outDependencies)) {
+        // Drop already loaded tasks on error
+        outTasks.clear();
+        outDependencies.clear();
+        return false;
+    }
+    // No file = not an error (first run)
+
+    // Replay mutations logged since the snapshot was written
+    int replayed = 0;
+    QVector<TaskJournal::Record> links;
+    qint64 journalEnd = 0;
+    quint64 generation = 0;
+    TaskJournal::replay(TaskJournal::pathFor(filePath), [&](const TaskJournal::Record &record) {
+        ++replayed;
+        // Writers sharing the journal may have appended out of stamp order
+        if (!takeStamp(record))
+            return;
+        if (record.op == TaskJournal::LinkOp || record.op == TaskJournal::UnlinkOp)
+            links.append(record);
+        else
+            applyJournalRecord(record, outTasks, outNextId);
+    }, &journalEnd, &generation);
+    applyLinkRecords(links, outDependencies);
+
+    if (m_journalEnabled)
+        openJournal(filePath);
+    markLoaded(version, generation, journalEnd);
+
+    qCDebug(lcTaskStore) << "TaskStore: Successfully loaded" << outTasks.size() << "tasks"
+             << "(" << replayed << "journal records replayed )";
+    return true;
+}
+
+void TaskStore::loadAsync(const QString &filePath)
+{
+    if (isLoading())
+        return;
+
+    // The journal is bounded by the compaction threshold, so it is read
+    // here; that lets it reopen for appends before the snapshot is in
+    const QPair<qint64, qint64> version = snapshotVersion(filePath);
+    JournalOverlay overlay;
+    qint64 journalEnd = 0;
+    quint64 generation = 0;
+    TaskJournal::replay(TaskJournal::pathFor(filePath), [this, &overlay](const TaskJournal::Record &record) {
+        if (takeStamp(record))
+            overlay.add(record);
+    }, &journalEnd, &generation);
+    if (m_journalEnabled)
+        openJournal(filePath);
+    markLoaded(version, generation, journalEnd);
+
+    // Batches are posted to this thread rather than kept in the future's
+    // result store, which would hold a second copy of the whole table until
+    // the next load. Posts still pending when the store goes are dropped.
+    m_loader.setFuture(QtConcurrent::run([this, filePath, overlay](QPromise<void> &promise) mutable {
+        auto post = [this](LoadResult result) {
+            QMetaObject::invokeMethod(this, [this, result = std::move(result)]() {
+                onLoadResult(result);
+            }, Qt::QueuedConnection);
+        };
+        auto deliver = [&](TaskTable &batch, int loaded, int total) {
+            if (promise.isCanceled())
+                return false;
+            overlay.apply(batch);
+
+            LoadResult result;
+            result.tasks = std::move(batch);
+            post(std::move(result));
+            promise.setProgressRange(0, total);
+            promise.setProgressValue(loaded);
+            return true;
+        };
+
+        LoadResult last;
+        last.last = true;
+
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadOnly))
+            last.ok = readSnapshot(file, LOAD_BATCH, deliver, last.nextId, last.dependencies);
         // No file = not an error (first run)
-        return true;
+
+        if (last.ok) {
+            last.tasks = overlay.takeAdded();
+            last.nextId = qMax(last.nextId, overlay.nextId);
+            applyLinkRecords(overlay.links, last.dependencies);
+        } else {
+            last.dependencies.clear();
+        }
+        post(std::move(last));
+    }));
+}
+
+void TaskStore::onLoadResult(const LoadResult &result)
+{
+    if (result.ok && !result.tasks.isEmpty())
+        emit loadBatchReady(result.tasks);
+    if (result.last) {
+        qCDebug(lcTaskStore) << "TaskStore: Background load" << (result.ok ? "finished" : "failed");
+        emit loadFinished(result.ok, result.nextId, result.dependencies);
     }
+}
 
-    QDataStream in(&file);
-    in.setVersion(QDataStream::Qt_6_5);
+bool TaskStore::readSnapshot(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                             QVector<TaskDependency> &outDependencies)
+{
+    TASK_TRACE_SCOPE("TaskStore::readSnapshot");
+    // Magic and version sit at the same offsets in every format version
+    const QByteArray head = file.peek(sizeof(quint32) + sizeof(quint16));
+    if (head.size() < int(sizeof(quint32) + sizeof(quint16))) {
+        qCWarning(lcTaskStore) << "TaskStore: File too short";
+        return false;
+    }
 
-    quint32 magic, count;
-    quint16 version;
+    if (qFromBigEndian<quint32>(head.constData()) != MAGIC) {
+        qCWarning(lcTaskStore) << "TaskStore: Invalid file format (wrong magic)";
+        return false;
+    }
+
+    const quint16 version = qFromBigEndian<quint16>(head.constData() + sizeof(quint32));
+    if (version < MIN_VERSION || version > VERSION) {
+        qCWarning(lcTaskStore) << "TaskStore: Unsupported file version:" << version;
+        return false;
+    }
+
+    if (version >= POOLED_VERSION)
+        return readPooled(file, batchSize, sink, outNextId, outDependencies);
+    if (version >= BLOCK_VERSION)
+        return readBlocks(file, batchSize, sink, outNextId, outDependencies);
+    if (version >= MAPPED_VERSION)
+        return readMapped(file, batchSize, sink, outNextId, outDependencies);
+    return readStream(file, version, batchSize, sink, outNextId);
+}
+
+bool TaskStore::readMapped(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies)
+{
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(DiskHeader))) {
+        qCWarning(lcTaskStore) << "TaskStore: Truncated header";
+        return false;
+    }
 
-    in >> magic;
-    if (magic != MAGIC) {
-        qWarning() << "TaskStore: Invalid file format (wrong magic)";
+    const uchar *base = file.map(0, fileSize);
+    if (!base) {
+        qCWarning(lcTaskStore) << "TaskStore: Cannot map file:" << file.errorString();
         return false;
     }
 
-    in >> version;
-    if (version != VERSION) {
-        qWarning() << "TaskStore: Unsupported file version:" << version;
+    // Records come first, so the section only needs to lie past them
+    const qint64 dataSize = readDependencySection(reinterpret_cast<const char *>(base), fileSize, outDependencies);
+
+    const DiskHeader *header = reinterpret_cast<const DiskHeader *>(base);
+    const quint32 count = header->count;
+    const quint32 recordSize = header->recordSize;
+    const quint16 headerSize = header->headerSize;
+
+    // Newer writers may grow the header or records; older fields stay put
+    if (headerSize < sizeof(DiskHeader) || headerSize % alignof(DiskRecord) != 0
+        || recordSize < sizeof(DiskRecord) || recordSize % alignof(DiskRecord) != 0
+        || dataSize < headerSize + qint64(count) * recordSize) {
+        qCWarning(lcTaskStore) << "TaskStore: Corrupt header or truncated records";
+        file.unmap(const_cast<uchar *>(base));
         return false;
     }
 
-    in >> count;
-    outTasks.reserve(count);
+    outNextId = header->nextId;
+    const bool scheduled = recordSize >= sizeof(DiskScheduledRecord);
+
+    const int total = int(count);
+    bool ok = true;
+    const uchar *cursor = base + headerSize;
+    for (int first = 0; ok && first < total; first += batchSize) {
+        const int n = qMin(batchSize, total - first);
+        TaskTable batch;
+        batch.reserve(n);
+
+        for (int i = 0; i < n; ++i, cursor += recordSize) {
+            const DiskRecord *rec = reinterpret_cast<const DiskRecord *>(cursor);
+            if (rec->status > COMPLETED || rec->priority > HIGH) {
+                qCWarning(lcTaskStore) << "TaskStore: Corrupt record" << first + i;
+                ok = false;
+                break;
+            }
+            const DiskSchedule *schedule = scheduled
+                                               ? reinterpret_cast<const DiskSchedule *>(cursor + sizeof(DiskRecord))
+                                               : nullptr;
+            batch.append(rec->id,
+                         static_cast<TaskStatus>(rec->status),
+                         static_cast<TaskPriority>(rec->priority),
+                         rec->createdMs,
+                         rec->completedMs,
+                         readField(rec->name, sizeof(rec->name)),
+                         readField(rec->description, sizeof(rec->description)),
+                         schedule ? qint64(schedule->dueMs) : 0,
+                         schedule ? qint64(schedule->reminderMs) : 0);
+        }
+
+        if (ok)
+            ok = sink(batch, first + n, total);
+    }
+
+    file.unmap(const_cast<uchar *>(base));
+    return ok;
+}
+
+bool TaskStore::readPooled(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies)
+{
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(DiskHeader))) {
+        qCWarning(lcTaskStore) << "TaskStore: Truncated header";
+        return false;
+    }
+
+    const uchar *base = file.map(0, fileSize);
+    if (!base) {
+        qCWarning(lcTaskStore) << "TaskStore: Cannot map file:" << file.errorString();
+        return false;
+    }
+
+    const qint64 dataSize = readDependencySection(reinterpret_cast<const char *>(base), fileSize, outDependencies);
+
+    const DiskHeader *header = reinterpret_cast<const DiskHeader *>(base);
+    const quint32 count = header->count;
+    const quint32 recordSize = header->recordSize;
+    const quint16 headerSize = header->headerSize;
+    const quint64 stringBytes = header->reserved;
+    const qint64 stringsAt = headerSize + qint64(count) * recordSize;
+
+    if (headerSize < sizeof(DiskHeader) || headerSize % alignof(PooledRecord) != 0
+        || recordSize < sizeof(PooledRecord) || recordSize % alignof(PooledRecord) != 0
+        || stringBytes >= quint64(std::numeric_limits<quint32>::max())
+        || dataSize < stringsAt + qint64(stringBytes)) {
+        qCWarning(lcTaskStore) << "TaskStore: Corrupt header or truncated records";
+        file.unmap(const_cast<uchar *>(base));
+        return false;
+    }
+
+    outNextId = header->nextId;
+
+    // The string section is copied out once and shared by every batch, so
+    // the loaded table references it in place rather than re-interning
+    const TaskStringPool strings = TaskStringPool::fromBytes(
+        QByteArray(reinterpret_cast<const char *>(base) + stringsAt, qsizetype(stringBytes)));
+
+    const int total = int(count);
+    bool ok = true;
+    const uchar *cursor = base + headerSize;
+    for (int first = 0; ok && first < total; first += batchSize) {
+        const int n = qMin(batchSize, total - first);
+        TaskTable batch;
+        batch.reserve(n);
+        batch.adoptStrings(strings);
+
+        for (int i = 0; i < n; ++i, cursor += recordSize) {
+            const PooledRecord *rec = reinterpret_cast<const PooledRecord *>(cursor);
+            const TaskStringPool::Ref name{rec->nameOffset, rec->nameLength};
+            const TaskStringPool::Ref description{rec->descriptionOffset, rec->descriptionLength};
+            if (rec->status > COMPLETED || rec->priority > HIGH
+                || !strings.contains(name) || !strings.contains(description)) {
+                qCWarning(lcTaskStore) << "TaskStore: Corrupt record" << first + i;
+                ok = false;
+                break;
+            }
+            batch.appendPooled(rec->id,
+                               static_cast<TaskStatus>(rec->status),
+                               static_cast<TaskPriority>(rec->priority),
+                               rec->createdMs,
+                               rec->completedMs,
+                               name,
+                               description,
+                               rec->dueMs,
+                               rec->reminderMs);
+        }
+
+        if (ok)
+            ok = sink(batch, first + n, total);
+    }
+
+    file.unmap(const_cast<uchar *>(base));
+    return ok;
+}
+
+bool TaskStore::readBlocks(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies)
+{
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(BlockFileHeader))) {
+        qCWarning(lcTaskStore) << "TaskStore: Truncated header";
+        return false;
+    }
+
+    const uchar *base = file.map(0, fileSize);
+    if (!base) {
+        qCWarning(lcTaskStore) << "TaskStore: Cannot map file:" << file.errorString();
+        return false;
+    }
+    const char *bytes = reinterpret_cast<const char *>(base);
+
+    // Blocks are looked for up to the dependency section, if there is one
+    const qint64 dataSize = readDependencySection(bytes, fileSize, outDependencies);
+
+    BlockFileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.headerCrc != crc32c(&header, offsetof(BlockFileHeader, headerCrc))
+        || header.headerSize < sizeof(BlockFileHeader) || header.headerSize > dataSize) {
+        qCWarning(lcTaskStore) << "TaskStore: Corrupt header";
+        file.unmap(const_cast<uchar *>(base));
+        return false;
+    }
+    outNextId = header.nextId;
+    const int total = int(header.count);
+    const bool scheduled = header.version >= SCHEDULE_VERSION;
+
+    // Locate the blocks. Only headers are read here; a damaged one is
+    // stepped over by scanning for the next magic that checks out.
+    struct BlockRef {
+        qint64 offset;          // payload
+        BlockHeader header;
+    };
+    QVector<BlockRef> blocks;
+    blocks.reserve(total / BLOCK_ROWS + 1);
+
+    const QByteArray view = QByteArray::fromRawData(bytes, dataSize);
+    const QByteArray marker = QByteArray::fromRawData("BKST", 4);   // BLOCK_MAGIC, little-endian
+    qint64 pos = header.headerSize;
+    qint64 damagedAt = -1;
+    while (pos + qint64(sizeof(BlockHeader)) <= dataSize) {
+        BlockHeader block;
+        std::memcpy(&block, bytes + pos, sizeof(block));
+        const qint64 payload = pos + sizeof(BlockHeader);
+        if (block.magic == BLOCK_MAGIC
+            && block.headerCrc == crc32c(&block, offsetof(BlockHeader, headerCrc))
+            && block.rows <= header.blockRows
+            && block.storedSize <= dataSize - payload) {
+            if (damagedAt >= 0) {
+                qCWarning(lcTaskStore) << "TaskStore: Skipped damaged bytes" << damagedAt << "to" << pos;
+                damagedAt = -1;
+            }
+            blocks.append({payload, block});
+            pos = payload + block.storedSize;
+            continue;
+        }
+        if (damagedAt < 0)
+            damagedAt = pos;
+        pos = view.indexOf(marker, pos + 1);
+        if (pos < 0)
+            break;
+    }
+    if (damagedAt >= 0)
+        qCWarning(lcTaskStore) << "TaskStore: Skipped damaged bytes from" << damagedAt << "to the end";
+
+    // Checksums and decompression run in parallel a wave at a time; rows
+    // are then appended in file order. Descriptions stay compressed until
+    // something reads them.
+    const auto descriptions = std::make_shared<BlockTextSource>();
+    int loaded = 0;
+    int lost = 0;
+    bool ok = true;
+    TaskTable batch;
+    batch.reserve(qMin(batchSize, total));
+
+    const int wave = blockWave();
+    for (int first = 0; ok && first < blocks.size(); first += wave) {
+        const QVector<BlockRef> slice = blocks.mid(first, wave);
+        const QVector<QByteArray> raws = QtConcurrent::blockingMapped<QVector<QByteArray>>(
+            slice, [bytes](const BlockRef &ref) {
+                const char *payload = bytes + ref.offset;
+                if (crc32c(payload, ref.header.storedSize) != ref.header.payloadCrc)
+                    return QByteArray();
+                const QByteArray raw = qUncompress(reinterpret_cast<const uchar *>(payload),
+                                                   ref.header.storedSize);
+                return raw.size() == qsizetype(ref.header.rawSize) ? raw : QByteArray();
+            });
+
+        for (int i = 0; ok && i < slice.size(); ++i) {
+            const int rows = int(slice.at(i).header.rows);
+            const QByteArray stored = QByteArray::fromRawData(bytes + slice.at(i).offset,
+                                                              slice.at(i).header.storedSize);
+            if (raws.at(i).isEmpty() || !unpackBlock(raws.at(i), stored, rows, scheduled, batch, descriptions)) {
+                qCWarning(lcTaskStore) << "TaskStore: Block" << first + i << "is corrupt;" << rows << "tasks lost";
+                lost += rows;
+            }
+            loaded += rows;
+
+            if (batch.size() >= batchSize) {
+                ok = sink(batch, qMin(loaded, total), total);
+                batch = TaskTable();
+                batch.reserve(qMin(batchSize, total - loaded));
+            }
+        }
+    }
+    if (ok && !batch.isEmpty())
+        ok = sink(batch, qMin(loaded, total), total);
+
+    const int missing = total - (loaded - lost);
+    if (ok && missing > 0)
+        qCWarning(lcTaskStore) << "TaskStore:" << missing << "of" << total << "tasks lost to damaged blocks";
+
+    file.unmap(const_cast<uchar *>(base));
+    return ok;
+}
+
+bool TaskStore::readStream(QFile &file, quint16 version, int batchSize, const BatchSink &sink, TaskId &outNextId)
+{
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic, count;
+    quint16 storedVersion;
+    in >> magic >> storedVersion >> count;
+    if (version >= 2) {
+        quint64 nextId;
+        in >> nextId;
+        outNextId = nextId;
+    }
+
+    const int total = int(count);
+    TaskTable batch;
+    batch.reserve(qMin(batchSize, total));
 
-    for (quint32 i = 0; i < count; ++i) {
-        Task *t = readTask(in, taskParent);
-        if (!t) {
-            qWarning() << "TaskStore: Failed to read task" << i;
-            // Clean up already loaded tasks on error
-            qDeleteAll(outTasks);
-            outTasks.clear();
+    for (int i = 0; i < total; ++i) {
+        Task t;
+        if (!readTask(in, version, t)) {
+            qCWarning(lcTaskStore) << "TaskStore: Failed to read task" << i;
             return false;
         }
-        outTasks.append(t);
+        batch.append(t);
+
+        // v1 files carry no counter, so derive it from the highest stored ID
+        if (t.taskId() >= outNextId)
+            outNextId = t.taskId() + 1;
+
+        if (batch.size() == batchSize || i == total - 1) {
+            if (!sink(batch, i + 1, total))
+                return false;
+            batch = TaskTable();
+            batch.reserve(qMin(batchSize, total - i - 1));
+        }
     }
 
-    qDebug() << "TaskStore: Successfully loaded" << outTasks.size() << "tasks";
     return true;
 }
 
-bool TaskStore::writeTask(QDataStream &out, const Task *task)
+void TaskStore::applyJournalRecord(const TaskJournal::Record &record, TaskTable &tasks, TaskId &nextId)
+{
+    const int row = tasks.rowOf(record.id);
+
+    switch (record.op) {
+    case TaskJournal::AddOp:
+        // IDs are never reused, so an existing row is this same task
+        // already folded into the snapshot
+        if (row < 0)
+            tasks.append(record.task);
+        if (record.id >= nextId)
+            nextId = record.id + 1;
+        break;
+    case TaskJournal::ReserveOp:
+        nextId = qMax(nextId, record.id);
+        break;
+    case TaskJournal::RemoveOp:
+        if (row >= 0)
+            tasks.removeAt(row);
+        break;
+    case TaskJournal::StatusOp:
+        if (row >= 0)
+            tasks.setStatus(row, record.status, record.timeMs);
+        break;
+    case TaskJournal::PriorityOp:
+        if (row >= 0)
+            tasks.setPriority(row, record.priority);
+        break;
+    case TaskJournal::EditOp:
+        if (row >= 0) {
+            tasks.setName(row, record.task.taskName());
+            tasks.setDescription(row, record.task.taskDescription());
+        }
+        break;
+    case TaskJournal::ScheduleOp:
+        if (row >= 0) {
+            tasks.setDueMs(row, record.dueMs);
+            tasks.setReminderMs(row, record.reminderMs);
+        }
+        break;
+    case TaskJournal::LinkOp:
+    case TaskJournal::UnlinkOp:
+        // Dependencies are replayed separately, by applyLinkRecords()
+        break;
+    }
+}
+
+bool TaskStore::openJournal(const QString &filePath)
+{
+    return m_journal.open(TaskJournal::pathFor(filePath));
+}
+
+bool TaskStore::journalAdd(const Task &task)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::AddOp;
+    record.id = task.taskId();
+    record.task = task;
+    return appendRecord(record);
+}
+
+bool TaskStore::journalRemove(TaskId id)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::RemoveOp;
+    record.id = id;
+    return appendRecord(record);
+}
+
+bool TaskStore::journalStatus(TaskId id, TaskStatus status, qint64 timeMs)
 {
-    out << task->toByteArray();
-    return (out.status() == QDataStream::Ok);
+    TaskJournal::Record record;
+    record.op = TaskJournal::StatusOp;
+    record.id = id;
+    record.status = status;
+    record.timeMs = timeMs;
+    return appendRecord(record);
 }
 
-Task* TaskStore::readTask(QDataStream &in, QObject *taskParent)
+bool TaskStore::journalPriority(TaskId id, TaskPriority priority)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::PriorityOp;
+    record.id = id;
+    record.priority = priority;
+    return appendRecord(record);
+}
+
+bool TaskStore::journalEdit(TaskId id, const QString &name, const QString &description)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::EditOp;
+    record.id = id;
+    record.task.setTaskName(name);
+    record.task.setTaskDescription(description);
+    return appendRecord(record);
+}
+
+bool TaskStore::journalSchedule(TaskId id, qint64 dueMs, qint64 reminderMs)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::ScheduleOp;
+    record.id = id;
+    record.dueMs = dueMs;
+    record.reminderMs = reminderMs;
+    return appendRecord(record);
+}
+
+bool TaskStore::journalLink(TaskId id, TaskId blockerId)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::LinkOp;
+    record.id = id;
+    record.blockerId = blockerId;
+    return appendRecord(record);
+}
+
+bool TaskStore::journalUnlink(TaskId id, TaskId blockerId)
+{
+    TaskJournal::Record record;
+    record.op = TaskJournal::UnlinkOp;
+    record.id = id;
+    record.blockerId = blockerId;
+    return appendRecord(record);
+}
+
+bool TaskStore::appendRecord(TaskJournal::Record &record)
+{
+    if (!m_journalEnabled)
+        return false;
+
+    // Later than anything written or read here, so a write that follows
+    // one seen from another instance also wins over it
+    m_clock = qMax(QDateTime::currentMSecsSinceEpoch(), m_clock + 1);
+    record.stamp = {m_clock, m_origin};
+    takeStamp(record);
+    return m_journal.append(record);
+}
+
+bool TaskStore::takeStamp(const TaskJournal::Record &record)
+{
+    m_clock = qMax(m_clock, record.stamp.time);
+
+    TaskJournal::Stamp *latest = nullptr;
+    switch (record.op) {
+    case TaskJournal::AddOp:
+    case TaskJournal::ReserveOp:
+        // IDs are never reused, so there is nothing to race with
+        return true;
+    case TaskJournal::RemoveOp:
+        // The task is gone for good; one stamp stands in for its fields
+        for (int op = TaskJournal::StatusOp; op <= TaskJournal::ScheduleOp; ++op)
+            m_fieldStamps.remove({record.id, op});
+        m_fieldStamps.insert({record.id, int(TaskJournal::RemoveOp)}, record.stamp);
+        return true;
+    case TaskJournal::LinkOp:
+    case TaskJournal::UnlinkOp:
+        latest = &m_linkStamps[{record.id, record.blockerId}];
+        break;
+    default:
+        // A removed task takes no more writes
+        if (m_fieldStamps.contains({record.id, int(TaskJournal::RemoveOp)}))
+            return false;
+        latest = &m_fieldStamps[{record.id, int(record.op)}];
+        break;
+    }
+    // Ties (unstamped records) go to the one read last, as in a replay
+    if (record.stamp < *latest)
+        return false;
+    *latest = record.stamp;
+    return true;
+}
+
+void TaskStore::setShared(bool shared)
+{
+    m_shared = shared;
+    m_journal.setShared(shared);
+}
+
+TaskStore::PollResult TaskStore::pollChanges(const QString &filePath, QVector<TaskJournal::Record> &outRecords)
+{
+    TASK_TRACE_SCOPE("TaskStore::pollChanges");
+    // A save of ours in flight changes the snapshot too; anyone else's
+    // rewrite also replaces the journal, which is caught below
+    if (!isSaving() && snapshotVersion(filePath) != m_snapshotVersion)
+        return Rewritten;
+
+    const bool current = TaskJournal::readTail(TaskJournal::pathFor(filePath), m_syncedGeneration, m_journalSeen,
+                                               [this, &outRecords](const TaskJournal::Record &record) {
+                                                   m_idFloor = qMax(m_idFloor, idsTakenBy(record));
+                                                   if (record.op == TaskJournal::ReserveOp)
+                                                       return;
+                                                   if (record.stamp.origin != m_origin && takeStamp(record))
+                                                       outRecords.append(record);
+                                               });
+    if (!current)
+        return Rewritten;
+    return outRecords.isEmpty() ? NoChanges : Changes;
+}
+
+TaskId TaskStore::reserveIds(TaskId nextId, int count, const QString &filePath)
+{
+    TASK_TRACE_SCOPE("TaskStore::reserveIds");
+    if (!m_shared || !m_journal.isOpen())
+        return nextId;
+    if (nextId >= m_reservedFrom && nextId + count <= m_reservedEnd)
+        return nextId;
+
+    if (!m_journal.lock()) {
+        qCWarning(lcTaskStore) << "TaskStore: Handing out IDs without a reservation";
+        return qMax(nextId, m_idFloor);
+    }
+
+    // Read, not consumed: pollChanges() still passes these records on
+    TaskId floor = qMax(nextId, m_idFloor);
+    auto note = [&floor](const TaskJournal::Record &record) { floor = qMax(floor, idsTakenBy(record)); };
+    const QString journalPath = TaskJournal::pathFor(filePath);
+    qint64 offset = m_journalSeen;
+    if (!TaskJournal::readTail(journalPath, m_syncedGeneration, offset, note)) {
+        // Rewritten since the last poll; what it dropped is in the snapshot
+        floor = qMax(floor, snapshotNextId(filePath));
+        TaskJournal::replay(journalPath, note);
+    }
+
+    TaskJournal::Record record;
+    record.op = TaskJournal::ReserveOp;
+    record.id = floor + qMax(count, ID_BLOCK);
+    appendRecord(record);
+    m_journal.unlock();
+
+    m_reservedFrom = floor;
+    m_reservedEnd = record.id;
+    m_idFloor = qMax(m_idFloor, m_reservedEnd);
+    return floor;
+}
+
+void TaskStore::markLoaded(const QPair<qint64, qint64> &version, quint64 generation, qint64 journalEnd)
+{
+    m_snapshotVersion = version;
+    // Opening the journal may have upgraded or recreated it; either way
+    // everything in it has just been replayed
+    if (m_journal.isOpen() && m_journal.generation() != generation) {
+        generation = m_journal.generation();
+        journalEnd = TaskJournal::HeaderSize + m_journal.recordBytes();
+    }
+    m_syncedGeneration = generation;
+    m_journalSeen = journalEnd;
+}
+
+void TaskStore::discardCovered(qint64 bytes, const QString &filePath)
+{
+    if (!m_journal.isOpen()) {
+        QFile::remove(TaskJournal::pathFor(filePath));
+        m_snapshotVersion = snapshotVersion(filePath);
+        m_syncedGeneration = 0;
+        m_journalSeen = 0;
+        return;
+    }
+
+    // How far the journal has been read moves up with the records kept,
+    // unless someone else replaced it first; pollChanges() finds that
+    const bool synced = m_syncedGeneration == m_journal.generation();
+    m_journal.discardBefore(bytes);
+    m_snapshotVersion = snapshotVersion(filePath);
+    if (synced) {
+        m_syncedGeneration = m_journal.generation();
+        m_journalSeen = qMax<qint64>(TaskJournal::HeaderSize, m_journalSeen - bytes);
+    }
+    pruneStamps();
+}
+
+void TaskStore::pruneStamps()
+{
+    // The snapshot now holds the writes behind these stamps. Alone on the
+    // files, nothing is left to compare them with; shared, they only guard
+    // against writes other instances have yet to append, so they are kept
+    // for a while. Links of removed tasks go with the tasks.
+    if (!m_shared) {
+        m_fieldStamps.clear();
+        m_linkStamps.clear();
+        return;
+    }
+
+    const qint64 horizon = m_clock - STAMP_RETENTION_MS;
+    QSet<TaskId> removed;
+    for (auto it = m_fieldStamps.begin(); it != m_fieldStamps.end();) {
+        if (it.key().second == TaskJournal::RemoveOp)
+            removed.insert(it.key().first);
+        if (it->time < horizon)
+            it = m_fieldStamps.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = m_linkStamps.begin(); it != m_linkStamps.end();) {
+        if (it->time < horizon || removed.contains(it.key().first) || removed.contains(it.key().second))
+            it = m_linkStamps.erase(it);
+        else
+            ++it;
+    }
+}
+
+qint64 TaskStore::coveredJournalBytes() const
+{
+    // Shared, only the records read back so far are in the tasks being
+    // saved; others may have appended more since, which must survive
+    if (!m_shared)
+        return m_journal.recordBytes();
+    if (m_syncedGeneration != m_journal.generation())
+        return 0;
+    return qBound<qint64>(0, m_journalSeen - TaskJournal::HeaderSize, m_journal.recordBytes());
+}
+
+bool TaskStore::needsCompaction() const
+{
+    return m_journalEnabled && m_journal.recordBytes() >= m_compactionThreshold;
+}
+
+bool TaskStore::readTask(QDataStream &in, quint16 version, Task &outTask)
 {
     QByteArray bytes;
     in >> bytes;
     if (bytes.isEmpty() || in.status() != QDataStream::Ok)
-        return nullptr;
+        return false;
 
-    return Task::fromByteArray(bytes, taskParent);
+    return Task::fromByteArray(bytes, version, outTask);
 }
@@ -2,24 +2,177 @@
 #define TASKSTORE_H
 
 #include <QObject>
-#include <QVector>
 #include <QString>
-
-class Task;
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPair>
+#include <optional>
+#include <functional>
+#include "Task.h"
+#include "TaskTable.h"
+#include "TaskJournal.h"
+#include "TaskGraph.h"
 
 class TaskStore : public QObject
 {
     Q_OBJECT
 public:
     explicit TaskStore(QObject *parent = nullptr);
+    ~TaskStore();
+
+    // nextId is the task ID counter; it is persisted so IDs are never reused.
+    // Dependencies are stored in the same file, after the tasks.
+    // Writes to a temporary file that atomically replaces filePath.
+    bool save(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+              TaskId nextId, const QString &filePath);
+
+    // Same as save(), but writes a snapshot of tasks on a worker thread and
+    // reports through saveFinished(). A request made while a write is in
+    // flight replaces any queued one, so bursts coalesce into one more write.
+    void saveAsync(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+                   TaskId nextId, const QString &filePath);
+    bool isSaving() const { return m_writer.isRunning(); }
+
+    // Loads the snapshot and replays its journal, if one exists.
+    // Dependencies may name tasks that are gone; TaskGraph drops those.
+    bool load(const QString &filePath, TaskTable &outTasks,
+              QVector<TaskDependency> &outDependencies, TaskId &outNextId);
+
+    // Decodes the snapshot on a worker thread. Rows arrive in file order
+    // through loadBatchReady() with the journal already applied, followed
+    // by loadFinished() with the dependencies.
+    void loadAsync(const QString &filePath);
+    bool isLoading() const { return m_loader.isRunning(); }
+
+    // Journal mode: mutations are appended to "<filePath>.journal" instead
+    // of rewriting the snapshot; a save folds them back in
+    void setJournalEnabled(bool enabled) { m_journalEnabled = enabled; }
+    bool isJournalEnabled() const { return m_journalEnabled; }
+    bool openJournal(const QString &filePath);
+
+    bool journalAdd(const Task &task);
+    bool journalRemove(TaskId id);
+    bool journalStatus(TaskId id, TaskStatus status, qint64 timeMs);
+    bool journalPriority(TaskId id, TaskPriority priority);
+    bool journalEdit(TaskId id, const QString &name, const QString &description);
+    bool journalSchedule(TaskId id, qint64 dueMs, qint64 reminderMs);
+    bool journalLink(TaskId id, TaskId blockerId);
+    bool journalUnlink(TaskId id, TaskId blockerId);
+
+    // Live sync: other instances, or scripts, may write the same snapshot
+    // and journal. Every journaled mutation is stamped, and appends follow
+    // the journal if someone else rewrites it.
+    void setShared(bool shared);
+    bool isShared() const { return m_shared; }
+
+    enum PollResult {
+        NoChanges,
+        Changes,        // outRecords holds the remote writes to apply
+        Rewritten       // the snapshot or journal was replaced; load() again
+    };
+
+    // Reads what other writers appended to the journal since the last
+    // load(), save or poll. Per field, a record is only passed on if no
+    // later-stamped write to that field has been seen, so every instance
+    // ends up with the last writer's value whatever order it reads in.
+    PollResult pollChanges(const QString &filePath, QVector<TaskJournal::Record> &outRecords);
 
-    bool save(const QVector<Task*> &tasks, const QString &filePath);
+    // Returns the first of count IDs that are free to hand out, nextId when
+    // not shared. Shared, IDs come from a range reserved in the journal
+    // under its lock, after reading what the others appended, so two
+    // instances never hand out the same ID.
+    TaskId reserveIds(TaskId nextId, int count, const QString &filePath);
 
-    bool load(const QString &filePath, QVector<Task*> &outTasks, QObject *taskParent = nullptr);
+    // Compaction is a saveAsync() once the journal passes this size
+    void setCompactionThreshold(qint64 bytes) { m_compactionThreshold = bytes; }
+    bool needsCompaction() const;
+
+    // Compressed format: rows are packed into blocks that are compressed and
+    // checksummed one by one, so files shrink several-fold and a damaged
+    // block costs only its own rows on load. Affects writing only; every
+    // format is read regardless.
+    void setCompressionEnabled(bool enabled) { m_compressionEnabled = enabled; }
+    bool isCompressionEnabled() const { return m_compressionEnabled; }
+
+signals:
+    void saveFinished(bool success);
+
+    void loadBatchReady(const TaskTable &batch);
+    void loadProgress(int loaded, int total);
+    void loadFinished(bool success, TaskId nextId, const QVector<TaskDependency> &dependencies);
 
 private:
-    bool writeTask(QDataStream &out, const Task *task);
-    Task* readTask(QDataStream &in, QObject *taskParent);
+    struct PendingSave {
+        TaskTable tasks;            // implicitly shared snapshot
+        QVector<TaskDependency> dependencies;
+        TaskId nextId = 1;
+        QString filePath;
+        bool compressed = false;
+        qint64 journalOffset = 0;   // journal bytes the snapshot covers
+    };
+
+    struct LoadResult {
+        TaskTable tasks;
+        QVector<TaskDependency> dependencies;   // the final result only
+        TaskId nextId = 1;          // set on the final result only
+        bool last = false;
+        bool ok = true;
+    };
+
+    bool m_journalEnabled = false;
+    bool m_compressionEnabled = false;
+    qint64 m_compactionThreshold = 1024 * 1024;
+    TaskJournal m_journal;
+    QFutureWatcher<bool> m_writer;
+    PendingSave m_running;          // valid while m_writer is running
+    std::optional<PendingSave> m_queued;
+    QFutureWatcher<void> m_loader;     // results arrive through onLoadResult()
+
+    // Live sync
+    bool m_shared = false;
+    quint64 m_origin;               // stamps the records written here
+    qint64 m_clock = 0;             // hybrid clock, ms
+    QHash<QPair<TaskId, int>, TaskJournal::Stamp> m_fieldStamps;   // (task, op) -> latest write; RemoveOp once gone
+    QHash<QPair<TaskId, TaskId>, TaskJournal::Stamp> m_linkStamps; // (task, blocker) -> latest write
+    TaskId m_idFloor = 1;           // past every ID reserved or added, here or as read
+    TaskId m_reservedFrom = 0;      // [from, end): reserved here and not yet handed out
+    TaskId m_reservedEnd = 0;
+    QPair<qint64, qint64> m_snapshotVersion{-1, 0};     // size and mtime as last read or written
+    quint64 m_syncedGeneration = 0; // journal read up to m_journalSeen; 0 = none
+    qint64 m_journalSeen = 0;
+
+    bool appendRecord(TaskJournal::Record &record);
+    bool takeStamp(const TaskJournal::Record &record);
+    void markLoaded(const QPair<qint64, qint64> &version, quint64 generation, qint64 journalEnd);
+    void discardCovered(qint64 bytes, const QString &filePath);
+    void pruneStamps();
+    qint64 coveredJournalBytes() const;
+
+    static bool writeFile(const TaskTable &tasks, const QVector<TaskDependency> &dependencies,
+                          TaskId nextId, const QString &filePath, bool compressed);
+    static bool writeSnapshot(const TaskTable &tasks, TaskId nextId, QIODevice &device);
+    static bool writeBlocks(const TaskTable &tasks, TaskId nextId, QIODevice &device);
+    static bool writeDependencies(const QVector<TaskDependency> &dependencies, QIODevice &device);
+    // Receives decoded rows in file order, up to batchSize at a time, along
+    // with how many of the total have been read; returning false stops reading
+    using BatchSink = std::function<bool(TaskTable &batch, int loaded, int total)>;
+
+    static bool readSnapshot(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                             QVector<TaskDependency> &outDependencies);
+    static bool readMapped(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies);
+    static bool readPooled(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies);
+    static bool readBlocks(QFile &file, int batchSize, const BatchSink &sink, TaskId &outNextId,
+                           QVector<TaskDependency> &outDependencies);
+    static bool readStream(QFile &file, quint16 version, int batchSize, const BatchSink &sink, TaskId &outNextId);
+    static bool readTask(QDataStream &in, quint16 version, Task &outTask);
+    static void applyJournalRecord(const TaskJournal::Record &record, TaskTable &tasks, TaskId &nextId);
+
+    void startSave(PendingSave request);
+    void onSaveFinished();
+    void onLoadResult(const LoadResult &result);
 };
 
 #endif // TASKSTORE_H
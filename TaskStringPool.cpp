@@ -0,0 +1,33 @@
+#include "TaskStringPool.h"
+#include <utility>
+
+TaskStringPool TaskStringPool::fromBytes(const QByteArray &bytes)
+{
+    TaskStringPool pool;
+    pool.m_bytes = bytes;
+    return pool;
+}
+
+TaskStringPool::Ref TaskStringPool::intern(QByteArrayView utf8)
+{
+    if (utf8.isEmpty())
+        return Ref();
+
+    const size_t hash = qHash(utf8);
+    const auto [first, last] = std::as_const(m_index).equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (this->utf8(*it) == utf8)
+            return *it;
+    }
+
+    const Ref ref{quint32(m_bytes.size()), quint32(utf8.size())};
+    m_bytes.append(utf8);
+    m_index.insert(hash, ref);
+    return ref;
+}
+
+void TaskStringPool::clear()
+{
+    m_bytes.clear();
+    m_index.clear();
+}
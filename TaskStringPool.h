@@ -0,0 +1,49 @@
+#ifndef TASKSTRINGPOOL_H
+#define TASKSTRINGPOOL_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QMultiHash>
+#include <QString>
+
+// Append-only UTF-8 arena for task text. A string is referred to by its
+// offset and length in the arena, so a row pays eight bytes per field and
+// empty text costs nothing. Interning text that is already in the pool
+// returns the existing reference instead of storing it again.
+//
+// Nothing is ever removed; TaskTable rebuilds its pool once replaced text
+// makes up too much of it. Copies are implicitly shared.
+class TaskStringPool
+{
+public:
+    struct Ref {
+        quint32 offset = 0;
+        quint32 length = 0;     // bytes
+    };
+
+    // Takes over bytes as the arena, e.g. a string section read from disk.
+    // Only text interned afterwards is deduplicated against.
+    static TaskStringPool fromBytes(const QByteArray &bytes);
+
+    Ref intern(QStringView text) { return intern(QByteArrayView(text.toUtf8())); }
+    Ref intern(QByteArrayView utf8);
+
+    QString text(Ref ref) const { return QString::fromUtf8(utf8(ref)); }
+    QByteArrayView utf8(Ref ref) const { return QByteArrayView(m_bytes.constData() + ref.offset, ref.length); }
+    bool contains(Ref ref) const { return qsizetype(ref.offset) + ref.length <= m_bytes.size(); }
+
+    const QByteArray &bytes() const { return m_bytes; }
+    qsizetype size() const { return m_bytes.size(); }
+    bool isSharedWith(const TaskStringPool &other) const { return m_bytes.isSharedWith(other.m_bytes); }
+
+    void reserve(qsizetype bytes) { m_bytes.reserve(bytes); }
+    void clear();
+
+private:
+    QByteArray m_bytes;
+    QMultiHash<size_t, Ref> m_index;    // content hash -> interned strings
+};
+
+Q_DECLARE_TYPEINFO(TaskStringPool::Ref, Q_PRIMITIVE_TYPE);
+
+#endif // TASKSTRINGPOOL_H
@@ -0,0 +1,448 @@
+#include "TaskTable.h"
+#include <QTimeZone>
+#include <algorithm>
+#include <iterator>
+
+void TaskTable::reserve(int rows)
+{
+    m_ids.reserve(rows);
+    m_status.reserve(rows);
+    m_priority.reserve(rows);
+    m_createdMs.reserve(rows);
+    m_completedMs.reserve(rows);
+    m_dueMs.reserve(rows);
+    m_reminderMs.reserve(rows);
+    m_blocked.reserve(rows);
+    m_nameRef.reserve(rows);
+    m_descRef.reserve(rows);
+    m_rowById.reserve(rows);
+}
+
+void TaskTable::clear()
+{
+    m_ids.clear();
+    m_status.clear();
+    m_priority.clear();
+    m_createdMs.clear();
+    m_completedMs.clear();
+    m_dueMs.clear();
+    m_reminderMs.clear();
+    m_blocked.clear();
+    m_nameRef.clear();
+    m_descRef.clear();
+    m_text.clear();
+    m_textBytes = 0;
+    m_deferred.reset();
+    m_rowById.clear();
+    std::fill(std::begin(m_statusCounts), std::end(m_statusCounts), 0);
+    std::fill(std::begin(m_priorityCounts), std::end(m_priorityCounts), 0);
+    m_blockedCount = 0;
+    m_ready.clear();
+    m_readyIndexed = false;
+}
+
+int TaskTable::append(const Task &task)
+{
+    return append(task.taskId(), task.status(), task.priority(),
+                  task.createdTime().toMSecsSinceEpoch(),
+                  task.completedTime().isValid() ? task.completedTime().toMSecsSinceEpoch() : 0,
+                  task.taskName(), task.taskDescription(),
+                  task.dueTime().isValid() ? task.dueTime().toMSecsSinceEpoch() : 0,
+                  task.reminderTime().isValid() ? task.reminderTime().toMSecsSinceEpoch() : 0);
+}
+
+int TaskTable::append(TaskId id, TaskStatus status, TaskPriority priority,
+                      qint64 createdMs, qint64 completedMs,
+                      const QString &name, const QString &description,
+                      qint64 dueMs, qint64 reminderMs)
+{
+    return appendRow(id, status, priority, createdMs, completedMs, dueMs, reminderMs,
+                     m_text.intern(name), m_text.intern(description));
+}
+
+int TaskTable::appendUtf8(TaskId id, TaskStatus status, TaskPriority priority,
+                          qint64 createdMs, qint64 completedMs,
+                          QByteArrayView name, QByteArrayView description,
+                          qint64 dueMs, qint64 reminderMs)
+{
+    return appendRow(id, status, priority, createdMs, completedMs, dueMs, reminderMs,
+                     m_text.intern(name), m_text.intern(description));
+}
+
+int TaskTable::appendDeferred(TaskId id, TaskStatus status, TaskPriority priority,
+                              qint64 createdMs, qint64 completedMs, QByteArrayView name,
+                              const std::shared_ptr<const TaskTextSource> &source, quint32 descriptionIndex,
+                              qint64 dueMs, qint64 reminderMs)
+{
+    if (!m_deferred)
+        m_deferred = source;
+    const TaskStringPool::Ref descRef = m_deferred == source
+                                            ? TaskStringPool::Ref{descriptionIndex, DeferredLength}
+                                            : m_text.intern(source->text(descriptionIndex));
+    return appendRow(id, status, priority, createdMs, completedMs, dueMs, reminderMs,
+                     m_text.intern(name), descRef);
+}
+
+void TaskTable::adoptStrings(const TaskStringPool &pool)
+{
+    Q_ASSERT(isEmpty());
+    m_text = pool;
+    m_textBytes = 0;
+}
+
+int TaskTable::appendPooled(TaskId id, TaskStatus status, TaskPriority priority,
+                            qint64 createdMs, qint64 completedMs,
+                            TaskStringPool::Ref name, TaskStringPool::Ref description,
+                            qint64 dueMs, qint64 reminderMs)
+{
+    Q_ASSERT(m_text.contains(name) && m_text.contains(description));
+    return appendRow(id, status, priority, createdMs, completedMs, dueMs, reminderMs, name, description);
+}
+
+void TaskTable::append(const TaskTable &other, int first, int count)
+{
+    reserve(size() + count);
+    if (!m_deferred)
+        m_deferred = other.m_deferred;
+
+    // Rows keep their references only if this table adopted other's pool;
+    // pools only grow, so they stay valid even after one side appends.
+    // Anything else copies just the text of the rows appended.
+    const bool sharedText = m_text.isSharedWith(other.m_text);
+
+    for (int row = first; row < first + count; ++row) {
+        TaskStringPool::Ref nameRef = other.m_nameRef.at(row);
+        TaskStringPool::Ref descRef = other.m_descRef.at(row);
+        if (!sharedText)
+            nameRef = m_text.intern(other.nameUtf8(row));
+        if (descRef.length == DeferredLength) {
+            if (m_deferred != other.m_deferred)
+                descRef = m_text.intern(other.description(row));
+        } else if (!sharedText) {
+            descRef = m_text.intern(other.m_text.utf8(descRef));
+        }
+        const int added = appendRow(other.id(row), other.status(row), other.priority(row),
+                                    other.createdMs(row), other.completedMs(row),
+                                    other.dueMs(row), other.reminderMs(row),
+                                    nameRef, descRef);
+        if (other.isBlocked(row))
+            setBlocked(added, true);
+    }
+}
+
+int TaskTable::appendRow(TaskId id, TaskStatus status, TaskPriority priority,
+                         qint64 createdMs, qint64 completedMs, qint64 dueMs, qint64 reminderMs,
+                         TaskStringPool::Ref nameRef, TaskStringPool::Ref descRef)
+{
+    const int row = m_ids.size();
+
+    m_ids.append(id);
+    m_status.append(status);
+    m_priority.append(priority);
+    m_createdMs.append(createdMs);
+    m_completedMs.append(completedMs);
+    m_dueMs.append(dueMs);
+    m_reminderMs.append(reminderMs);
+    m_blocked.append(false);
+    m_nameRef.append(nameRef);
+    m_descRef.append(descRef);
+    m_textBytes += textBytes(row);
+
+    ++m_statusCounts[status];
+    ++m_priorityCounts[priority];
+    if (m_readyIndexed && status == PENDING)
+        m_ready.insert(id);
+
+    m_rowById.insert(id, row);
+    return row;
+}
+
+void TaskTable::removeRange(int first, int count)
+{
+    for (int row = first; row < first + count; ++row) {
+        m_rowById.remove(m_ids.at(row));
+        if (m_readyIndexed)
+            m_ready.remove(m_ids.at(row));
+        --m_statusCounts[m_status.at(row)];
+        --m_priorityCounts[m_priority.at(row)];
+        m_blockedCount -= m_blocked.at(row);
+        m_textBytes -= textBytes(row);
+    }
+
+    m_ids.remove(first, count);
+    m_status.remove(first, count);
+    m_priority.remove(first, count);
+    m_createdMs.remove(first, count);
+    m_completedMs.remove(first, count);
+    m_dueMs.remove(first, count);
+    m_reminderMs.remove(first, count);
+    m_blocked.remove(first, count);
+    m_nameRef.remove(first, count);
+    m_descRef.remove(first, count);
+
+    reindexFrom(first);
+    compactStringsIfNeeded();
+}
+
+void TaskTable::removeRows(const QVector<int> &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    for (int row : rows) {
+        m_rowById.remove(m_ids.at(row));
+        if (m_readyIndexed)
+            m_ready.remove(m_ids.at(row));
+        --m_statusCounts[m_status.at(row)];
+        --m_priorityCounts[m_priority.at(row)];
+        m_blockedCount -= m_blocked.at(row);
+        m_textBytes -= textBytes(row);
+    }
+
+    compactColumn(m_ids, rows);
+    compactColumn(m_status, rows);
+    compactColumn(m_priority, rows);
+    compactColumn(m_createdMs, rows);
+    compactColumn(m_completedMs, rows);
+    compactColumn(m_dueMs, rows);
+    compactColumn(m_reminderMs, rows);
+    compactColumn(m_blocked, rows);
+    compactColumn(m_nameRef, rows);
+    compactColumn(m_descRef, rows);
+
+    reindexFrom(rows.first());
+    compactStringsIfNeeded();
+}
+
+Task TaskTable::taskAt(int row) const
+{
+    Task task(id(row), name(row), description(row), priority(row));
+    task.setStatus(status(row));
+    task.setCreatedTime(QDateTime::fromMSecsSinceEpoch(createdMs(row), QTimeZone::UTC));
+    task.setCompletedTime(completedMs(row) != 0
+                              ? QDateTime::fromMSecsSinceEpoch(completedMs(row), QTimeZone::UTC)
+                              : QDateTime());
+    task.setDueTime(dueMs(row) != 0 ? QDateTime::fromMSecsSinceEpoch(dueMs(row), QTimeZone::UTC)
+                                    : QDateTime());
+    task.setReminderTime(reminderMs(row) != 0
+                             ? QDateTime::fromMSecsSinceEpoch(reminderMs(row), QTimeZone::UTC)
+                             : QDateTime());
+    return task;
+}
+
+void TaskTable::setStatus(int row, TaskStatus status, qint64 nowMs)
+{
+    --m_statusCounts[m_status.at(row)];
+    ++m_statusCounts[status];
+    m_status[row] = status;
+    if (status == COMPLETED)
+        m_completedMs[row] = nowMs;
+    updateReady(row);
+}
+
+void TaskTable::setPriority(int row, TaskPriority priority)
+{
+    --m_priorityCounts[m_priority.at(row)];
+    ++m_priorityCounts[priority];
+    m_priority[row] = priority;
+}
+
+void TaskTable::setBlocked(int row, bool blocked)
+{
+    m_blockedCount += int(blocked) - int(m_blocked.at(row));
+    m_blocked[row] = blocked;
+    updateReady(row);
+}
+
+void TaskTable::indexReady()
+{
+    m_ready.clear();
+    m_ready.reserve(statusCount(PENDING));
+    for (int row = 0; row < m_ids.size(); ++row) {
+        if (m_status.at(row) == PENDING && !m_blocked.at(row))
+            m_ready.insert(m_ids.at(row));
+    }
+    m_readyIndexed = true;
+}
+
+QVector<TaskId> TaskTable::readyIds() const
+{
+    QVector<int> rows;
+    if (m_readyIndexed) {
+        rows.reserve(m_ready.size());
+        for (TaskId id : m_ready)
+            rows.append(rowOf(id));
+        std::sort(rows.begin(), rows.end());
+    } else {
+        for (int row : rowsWithStatus(PENDING)) {
+            if (!m_blocked.at(row))
+                rows.append(row);
+        }
+    }
+
+    QVector<TaskId> ids;
+    ids.reserve(rows.size());
+    for (int row : std::as_const(rows))
+        ids.append(m_ids.at(row));
+    return ids;
+}
+
+void TaskTable::updateReady(int row)
+{
+    if (!m_readyIndexed)
+        return;
+    if (m_status.at(row) == PENDING && !m_blocked.at(row))
+        m_ready.insert(m_ids.at(row));
+    else
+        m_ready.remove(m_ids.at(row));
+}
+
+void TaskTable::setName(int row, const QString &name)
+{
+    m_textBytes -= textBytes(row);
+    m_nameRef[row] = m_text.intern(name);
+    m_textBytes += textBytes(row);
+    compactStringsIfNeeded();
+}
+
+void TaskTable::setDescription(int row, const QString &description)
+{
+    m_textBytes -= textBytes(row);
+    m_descRef[row] = m_text.intern(description);
+    m_textBytes += textBytes(row);
+    compactStringsIfNeeded();
+}
+
+QByteArray TaskTable::descriptionUtf8(int row) const
+{
+    if (isDescriptionDeferred(row))
+        return description(row).toUtf8();
+    return m_text.utf8(m_descRef.at(row)).toByteArray();
+}
+
+QVector<int> TaskTable::rowsWithStatus(TaskStatus status) const
+{
+    QVector<int> rows;
+    const TaskStatus *column = m_status.constData();
+    for (int i = 0; i < m_status.size(); ++i) {
+        if (column[i] == status)
+            rows.append(i);
+    }
+    return rows;
+}
+
+QVector<int> TaskTable::rowsWithPriority(TaskPriority priority) const
+{
+    QVector<int> rows;
+    const TaskPriority *column = m_priority.constData();
+    for (int i = 0; i < m_priority.size(); ++i) {
+        if (column[i] == priority)
+            rows.append(i);
+    }
+    return rows;
+}
+
+void TaskTable::permute(const QVector<int> &order)
+{
+    Q_ASSERT(order.size() == size());
+
+    permuteColumn(m_ids, order);
+    permuteColumn(m_status, order);
+    permuteColumn(m_priority, order);
+    permuteColumn(m_createdMs, order);
+    permuteColumn(m_completedMs, order);
+    permuteColumn(m_dueMs, order);
+    permuteColumn(m_reminderMs, order);
+    permuteColumn(m_blocked, order);
+    permuteColumn(m_nameRef, order);
+    permuteColumn(m_descRef, order);
+
+    reindexFrom(0);
+}
+
+void TaskTable::move(int from, int to)
+{
+    if (from == to)
+        return;
+
+    moveInColumn(m_ids, from, to);
+    moveInColumn(m_status, from, to);
+    moveInColumn(m_priority, from, to);
+    moveInColumn(m_createdMs, from, to);
+    moveInColumn(m_completedMs, from, to);
+    moveInColumn(m_dueMs, from, to);
+    moveInColumn(m_reminderMs, from, to);
+    moveInColumn(m_blocked, from, to);
+    moveInColumn(m_nameRef, from, to);
+    moveInColumn(m_descRef, from, to);
+
+    // Only the rows between the two positions shift
+    const int last = qMax(from, to);
+    for (int i = qMin(from, to); i <= last; ++i)
+        m_rowById[m_ids.at(i)] = i;
+}
+
+template <typename T>
+void TaskTable::compactColumn(QVector<T> &column, const QVector<int> &removedRows)
+{
+    // Shift survivors down over the removed rows, then drop the tail
+    int write = removedRows.first();
+    int next = 0;
+    for (int read = write; read < column.size(); ++read) {
+        if (next < removedRows.size() && removedRows.at(next) == read) {
+            ++next;
+            continue;
+        }
+        column[write++] = column.at(read);
+    }
+    column.resize(write);
+}
+
+template <typename T>
+void TaskTable::moveInColumn(QVector<T> &column, int from, int to)
+{
+    T *data = column.data();
+    if (from < to)
+        std::rotate(data + from, data + from + 1, data + to + 1);
+    else
+        std::rotate(data + to, data + from, data + from + 1);
+}
+
+template <typename T>
+void TaskTable::permuteColumn(QVector<T> &column, const QVector<int> &order)
+{
+    QVector<T> reordered;
+    reordered.reserve(column.size());
+    for (int from : order)
+        reordered.append(column.at(from));
+    column.swap(reordered);
+}
+
+qsizetype TaskTable::textBytes(int row) const
+{
+    // Deferred descriptions are not in the pool
+    const TaskStringPool::Ref desc = m_descRef.at(row);
+    return qsizetype(m_nameRef.at(row).length) + (desc.length == DeferredLength ? 0 : desc.length);
+}
+
+void TaskTable::compactStringsIfNeeded()
+{
+    // Edits and removals leave their old text behind in the pool
+    if (m_text.size() <= 2 * m_textBytes + CompactSlack)
+        return;
+
+    TaskStringPool compacted;
+    compacted.reserve(m_textBytes);
+    for (int row = 0; row < size(); ++row) {
+        m_nameRef[row] = compacted.intern(m_text.utf8(m_nameRef.at(row)));
+        if (!isDescriptionDeferred(row))
+            m_descRef[row] = compacted.intern(m_text.utf8(m_descRef.at(row)));
+    }
+    m_text = compacted;
+}
+
+void TaskTable::reindexFrom(int from)
+{
+    for (int i = from; i < m_ids.size(); ++i)
+        m_rowById[m_ids.at(i)] = i;
+}
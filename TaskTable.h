@@ -0,0 +1,191 @@
+#ifndef TASKTABLE_H
+#define TASKTABLE_H
+
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <memory>
+#include "Task.h"
+#include "TaskStringPool.h"
+
+// Supplies text that has not been decoded yet, by index; see
+// TaskTable::appendDeferred(). Called from any thread.
+class TaskTextSource
+{
+public:
+    virtual ~TaskTextSource() = default;
+    virtual QString text(quint32 index) const = 0;
+};
+
+// Struct-of-arrays storage for tasks. Each field lives in its own
+// contiguous column, indexed by row; row order is the display order.
+// Names and descriptions are UTF-8 in a TaskStringPool and referenced from
+// the row by offset and length, so text has no length limit, repeated text
+// is stored once and empty text costs nothing. All columns are implicitly
+// shared, so copying a TaskTable is cheap and yields an independent
+// snapshot.
+//
+// Descriptions may be deferred: the row then refers to an entry of a
+// TaskTextSource, which decodes it only when description() is called.
+class TaskTable
+{
+public:
+    int size() const { return m_ids.size(); }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+    void reserve(int rows);
+    void clear();
+
+    // Appends a row built from task and returns its index
+    int append(const Task &task);
+    // Appends a row straight from field values, without building a Task
+    int append(TaskId id, TaskStatus status, TaskPriority priority,
+               qint64 createdMs, qint64 completedMs,
+               const QString &name, const QString &description,
+               qint64 dueMs = 0, qint64 reminderMs = 0);
+    // Same, with the text already UTF-8, as loaders have it
+    int appendUtf8(TaskId id, TaskStatus status, TaskPriority priority,
+                   qint64 createdMs, qint64 completedMs,
+                   QByteArrayView name, QByteArrayView description,
+                   qint64 dueMs = 0, qint64 reminderMs = 0);
+    // Same, with the description left in source until it is first read.
+    // A table draws deferred text from one source; rows from another are
+    // decoded on append.
+    int appendDeferred(TaskId id, TaskStatus status, TaskPriority priority,
+                       qint64 createdMs, qint64 completedMs, QByteArrayView name,
+                       const std::shared_ptr<const TaskTextSource> &source, quint32 descriptionIndex,
+                       qint64 dueMs = 0, qint64 reminderMs = 0);
+    // Same, with the text already in pool, which an empty table takes over
+    // as its own first; refs must lie within it
+    void adoptStrings(const TaskStringPool &pool);
+    const TaskStringPool &strings() const { return m_text; }
+    int appendPooled(TaskId id, TaskStatus status, TaskPriority priority,
+                     qint64 createdMs, qint64 completedMs,
+                     TaskStringPool::Ref name, TaskStringPool::Ref description,
+                     qint64 dueMs = 0, qint64 reminderMs = 0);
+    // Appends every row of other, in order; deferred descriptions stay
+    // deferred, and text is copied over unless both tables share a pool
+    void append(const TaskTable &other) { append(other, 0, other.size()); }
+    // Same for count rows of other starting at first
+    void append(const TaskTable &other, int first, int count);
+    void removeAt(int row) { removeRange(row, 1); }
+    void removeRange(int first, int count);
+    // Removes the given rows (ascending, unique) in one pass
+    void removeRows(const QVector<int> &rows);
+
+    // Materializes one row as a Task value
+    Task taskAt(int row) const;
+
+    // Row of a task, or -1. Constant time.
+    int rowOf(TaskId id) const { return m_rowById.value(id, -1); }
+    bool contains(TaskId id) const { return m_rowById.contains(id); }
+
+    // Per-row field access
+    TaskId id(int row) const { return m_ids.at(row); }
+    TaskStatus status(int row) const { return m_status.at(row); }
+    TaskPriority priority(int row) const { return m_priority.at(row); }
+    qint64 createdMs(int row) const { return m_createdMs.at(row); }
+    qint64 completedMs(int row) const { return m_completedMs.at(row); }  // 0 when not completed
+    qint64 dueMs(int row) const { return m_dueMs.at(row); }              // 0 when not set
+    qint64 reminderMs(int row) const { return m_reminderMs.at(row); }    // 0 when not set
+    QString name(int row) const { return m_text.text(m_nameRef.at(row)); }
+    QString description(int row) const
+    {
+        const TaskStringPool::Ref ref = m_descRef.at(row);
+        return ref.length == DeferredLength ? m_deferred->text(ref.offset) : m_text.text(ref);
+    }
+    bool isDescriptionDeferred(int row) const { return m_descRef.at(row).length == DeferredLength; }
+    // The stored UTF-8; a deferred description is decoded and re-encoded
+    QByteArrayView nameUtf8(int row) const { return m_text.utf8(m_nameRef.at(row)); }
+    QByteArray descriptionUtf8(int row) const;
+    // Derived from the dependency graph by its owner; not persisted
+    bool isBlocked(int row) const { return m_blocked.at(row); }
+
+    void setStatus(int row, TaskStatus status, qint64 nowMs);
+    void setPriority(int row, TaskPriority priority);
+    void setName(int row, const QString &name);
+    void setDescription(int row, const QString &description);
+    void setDueMs(int row, qint64 dueMs) { m_dueMs[row] = dueMs; }
+    void setReminderMs(int row, qint64 reminderMs) { m_reminderMs[row] = reminderMs; }
+    void setBlocked(int row, bool blocked);
+
+    // Whole columns, for scans over contiguous memory
+    const QVector<TaskId> &ids() const { return m_ids; }
+    const QVector<TaskStatus> &statuses() const { return m_status; }
+    const QVector<TaskPriority> &priorities() const { return m_priority; }
+    const QVector<qint64> &createdTimes() const { return m_createdMs; }
+    const QVector<qint64> &completedTimes() const { return m_completedMs; }
+    const QVector<qint64> &dueTimes() const { return m_dueMs; }
+    const QVector<qint64> &reminderTimes() const { return m_reminderMs; }
+
+    // Rows per status / priority, kept current by every mutation. O(1).
+    int statusCount(TaskStatus status) const { return m_statusCounts[status]; }
+    int priorityCount(TaskPriority priority) const { return m_priorityCounts[priority]; }
+    int blockedCount() const { return m_blockedCount; }
+
+    // Filtering scans a single byte column
+    QVector<int> rowsWithStatus(TaskStatus status) const;
+    QVector<int> rowsWithPriority(TaskPriority priority) const;
+
+    // IDs of the pending rows that are not blocked, in row order. A scan
+    // until indexReady() is called; from then on every mutation keeps the
+    // set current, and the call costs only the ready rows. clear() and
+    // load drop the index again.
+    void indexReady();
+    bool isReadyIndexed() const { return m_readyIndexed; }
+    QVector<TaskId> readyIds() const;
+
+    // Reorders every column so that new row i is old row order[i]
+    void permute(const QVector<int> &order);
+
+    // Moves one row so that it ends up at index to
+    void move(int from, int to);
+
+private:
+    // A description ref of this length holds an index into m_deferred
+    static constexpr quint32 DeferredLength = 0xFFFFFFFFu;
+    // Replaced text is reclaimed once the pool outgrows twice the live
+    // text by this much
+    static constexpr qsizetype CompactSlack = 64 * 1024;
+
+    QVector<TaskId> m_ids;
+    QVector<TaskStatus> m_status;
+    QVector<TaskPriority> m_priority;
+    QVector<qint64> m_createdMs;
+    QVector<qint64> m_completedMs;
+    QVector<qint64> m_dueMs;
+    QVector<qint64> m_reminderMs;
+    QVector<bool> m_blocked;
+    QVector<TaskStringPool::Ref> m_nameRef;
+    QVector<TaskStringPool::Ref> m_descRef;
+
+    TaskStringPool m_text;
+    qsizetype m_textBytes = 0;      // referenced by rows, repeats included
+    std::shared_ptr<const TaskTextSource> m_deferred;
+
+    QHash<TaskId, int> m_rowById;   // task ID -> row
+
+    int m_statusCounts[COMPLETED + 1] = {};
+    int m_priorityCounts[HIGH + 1] = {};
+    int m_blockedCount = 0;
+
+    QSet<TaskId> m_ready;
+    bool m_readyIndexed = false;
+
+    void updateReady(int row);
+    int appendRow(TaskId id, TaskStatus status, TaskPriority priority,
+                  qint64 createdMs, qint64 completedMs, qint64 dueMs, qint64 reminderMs,
+                  TaskStringPool::Ref nameRef, TaskStringPool::Ref descRef);
+    qsizetype textBytes(int row) const;
+    void compactStringsIfNeeded();
+    void reindexFrom(int from);
+
+    template <typename T>
+    static void permuteColumn(QVector<T> &column, const QVector<int> &order);
+    template <typename T>
+    static void compactColumn(QVector<T> &column, const QVector<int> &removedRows);
+    template <typename T>
+    static void moveInColumn(QVector<T> &column, int from, int to);
+};
+
+#endif // TASKTABLE_H
@@ -0,0 +1,208 @@
+#include "TaskTrace.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr quint64 RingSize = 1 << 14;   // spans kept per thread
+
+struct Event {
+    const char *name;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+struct ThreadBuffer {
+    int threadId = 0;
+    QString threadName;
+    std::atomic<quint64> head{0};        // events ever recorded
+    Event events[RingSize];
+};
+
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;  // outlive their threads
+    std::vector<TaskTrace::Counter *> counters;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadBuffer *t_buffer = nullptr;
+
+ThreadBuffer *threadBuffer()
+{
+    if (t_buffer)
+        return t_buffer;
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    QThread *thread = QThread::currentThread();
+    buffer->threadName = thread->objectName();
+    if (buffer->threadName.isEmpty() && QCoreApplication::instance()
+        && thread == QCoreApplication::instance()->thread())
+        buffer->threadName = QStringLiteral("main");
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    buffer->threadId = int(reg.buffers.size()) + 1;
+    t_buffer = buffer.get();
+    reg.buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+void appendJsonString(QByteArray &out, const QString &text)
+{
+    out += '"';
+    for (QChar c : text) {
+        if (c == u'"' || c == u'\\')
+            out += '\\';
+        if (c.unicode() < 0x20)
+            out += ' ';
+        else
+            out += QString(c).toUtf8();
+    }
+    out += '"';
+}
+
+} // namespace
+
+TaskTrace::Counter::Counter(const char *name)
+    : name(name)
+{
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    reg.counters.push_back(this);
+}
+
+void TaskTrace::Span::finish()
+{
+    const qint64 durationNs = now() - m_startNs;
+
+    Counter &counter = *m_counter;
+    counter.calls.fetch_add(1, std::memory_order_relaxed);
+    counter.totalNs.fetch_add(quint64(durationNs), std::memory_order_relaxed);
+    quint64 worst = counter.maxNs.load(std::memory_order_relaxed);
+    while (quint64(durationNs) > worst
+           && !counter.maxNs.compare_exchange_weak(worst, quint64(durationNs), std::memory_order_relaxed)) {
+    }
+
+    // Single writer per buffer: fill the slot, then publish it
+    ThreadBuffer *buffer = threadBuffer();
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % RingSize] = {counter.name, m_startNs, durationNs};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+qint64 TaskTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QVector<TaskTrace::CounterValues> TaskTrace::counters()
+{
+    // Several sites may share a name, e.g. a span in an inline function
+    QHash<QString, CounterValues> byName;
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        for (const Counter *counter : reg.counters) {
+            CounterValues &values = byName[QString::fromLatin1(counter->name)];
+            values.name = QString::fromLatin1(counter->name);
+            values.calls += counter->calls.load(std::memory_order_relaxed);
+            values.totalNs += counter->totalNs.load(std::memory_order_relaxed);
+            values.maxNs = qMax(values.maxNs, counter->maxNs.load(std::memory_order_relaxed));
+        }
+    }
+
+    QVector<CounterValues> result(byName.cbegin(), byName.cend());
+    std::sort(result.begin(), result.end(), [](const CounterValues &a, const CounterValues &b) {
+        return a.totalNs != b.totalNs ? a.totalNs > b.totalNs : a.name < b.name;
+    });
+    return result;
+}
+
+void TaskTrace::resetCounters()
+{
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (Counter *counter : reg.counters) {
+        counter->calls.store(0, std::memory_order_relaxed);
+        counter->totalNs.store(0, std::memory_order_relaxed);
+        counter->maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TaskTrace::writeChromeTrace(QIODevice &out)
+{
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            json += ",\n";
+        first = false;
+    };
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const auto &buffer : reg.buffers) {
+        separator();
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + QByteArray::number(pid)
+                + ",\"tid\":" + QByteArray::number(buffer->threadId) + ",\"args\":{\"name\":";
+        appendJsonString(json, buffer->threadName.isEmpty()
+                                   ? QStringLiteral("thread %1").arg(buffer->threadId)
+                                   : buffer->threadName);
+        json += "}}";
+
+        // Copy the live window, then drop whatever the owner overwrote
+        // while we were copying
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 begin = head > RingSize ? head - RingSize : 0;
+        std::vector<Event> events;
+        events.reserve(head - begin);
+        for (quint64 i = begin; i < head; ++i)
+            events.push_back(buffer->events[i % RingSize]);
+        const quint64 after = buffer->head.load(std::memory_order_acquire);
+        const quint64 stale = after > RingSize ? after - RingSize : 0;
+        const size_t skip = stale > begin ? size_t(qMin(stale - begin, quint64(events.size()))) : 0;
+
+        for (size_t i = skip; i < events.size(); ++i) {
+            const Event &event = events[i];
+            separator();
+            json += "{\"name\":\"";
+            json += event.name;
+            json += "\",\"ph\":\"X\",\"pid\":" + QByteArray::number(pid)
+                    + ",\"tid\":" + QByteArray::number(buffer->threadId)
+                    + ",\"ts\":" + QByteArray::number(double(event.startNs) / 1000.0, 'f', 3)
+                    + ",\"dur\":" + QByteArray::number(double(event.durationNs) / 1000.0, 'f', 3)
+                    + '}';
+        }
+    }
+    locker.unlock();
+
+    json += "\n]}\n";
+    return out.write(json) == json.size();
+}
+
+bool TaskTrace::writeChromeTrace(const QString &filePath)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    if (!writeChromeTrace(file)) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
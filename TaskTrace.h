@@ -0,0 +1,91 @@
+#ifndef TASKTRACE_H
+#define TASKTRACE_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+class QIODevice;
+
+// Scoped-span tracing for hot paths. TASK_TRACE_SCOPE("name") times the
+// rest of the enclosing block. While tracing is off a span costs a relaxed
+// atomic load; building with TASKMANAGER_NO_TRACE compiles spans out.
+//
+// Every thread records into its own fixed-size ring buffer that only it
+// writes, so recording takes no lock; once full, the oldest events are
+// overwritten. Each span name also has counters (calls, total and worst
+// time) for a live overview.
+class TaskTrace
+{
+public:
+    // One per TASK_TRACE_SCOPE site; registers itself on first use
+    struct Counter {
+        explicit Counter(const char *name);
+
+        const char *const name;
+        std::atomic<quint64> calls{0};
+        std::atomic<quint64> totalNs{0};
+        std::atomic<quint64> maxNs{0};
+    };
+
+    struct CounterValues {
+        QString name;
+        quint64 calls = 0;
+        quint64 totalNs = 0;
+        quint64 maxNs = 0;
+    };
+
+    class Span
+    {
+    public:
+        explicit Span(Counter &counter)
+            : m_counter(isEnabled() ? &counter : nullptr)
+            , m_startNs(m_counter ? now() : 0)
+        {}
+        ~Span()
+        {
+            if (m_counter)
+                finish();
+        }
+        Q_DISABLE_COPY(Span)
+
+    private:
+        Counter *m_counter;
+        qint64 m_startNs;
+
+        void finish();
+    };
+
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Counters merged by span name, busiest first
+    static QVector<CounterValues> counters();
+    static void resetCounters();
+
+    // Writes the buffered spans as Chrome trace event JSON, which
+    // chrome://tracing and ui.perfetto.dev open directly. Meant to be
+    // called while traced threads are quiet; spans recorded meanwhile
+    // may be left out.
+    static bool writeChromeTrace(QIODevice &out);
+    static bool writeChromeTrace(const QString &filePath);
+
+    // Nanoseconds on a monotonic clock
+    static qint64 now();
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+#ifdef TASKMANAGER_NO_TRACE
+#  define TASK_TRACE_SCOPE(name) static_cast<void>(0)
+#else
+#  define TASK_TRACE_JOIN_(a, b) a##b
+#  define TASK_TRACE_JOIN(a, b) TASK_TRACE_JOIN_(a, b)
+#  define TASK_TRACE_SCOPE(name) \
+       static TaskTrace::Counter TASK_TRACE_JOIN(taskTraceCounter_, __LINE__)(name); \
+       const TaskTrace::Span TASK_TRACE_JOIN(taskTraceSpan_, __LINE__)(TASK_TRACE_JOIN(taskTraceCounter_, __LINE__))
+#endif
+
+#endif // TASKTRACE_H
@@ -0,0 +1,547 @@
+#include "TaskTransfer.h"
+#include <QIODevice>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <cstring>
+#include "TaskTrace.h"
+
+namespace {
+
+// Below this a chunk is not worth a thread of its own
+constexpr qsizetype MinChunkBytes = 256 * 1024;
+constexpr int ExportChunkRows = 16384;
+
+enum Column {
+    NameColumn,
+    DescriptionColumn,
+    PriorityColumn,
+    StatusColumn,
+    CreatedColumn,
+    CompletedColumn,
+    DueColumn,
+    ReminderColumn,
+    ColumnCount
+};
+
+struct Chunk {
+    qsizetype begin = 0;
+    qsizetype end = 0;
+};
+
+// Columns of one parsed chunk, in input order
+struct ParsedChunk {
+    QVector<TaskStatus> status;
+    QVector<TaskPriority> priority;
+    QVector<qint64> createdMs;
+    QVector<qint64> completedMs;
+    QVector<qint64> dueMs;
+    QVector<qint64> reminderMs;
+    QStringList names;
+    QStringList descriptions;
+
+    int lines = 0;              // line breaks consumed, to number later chunks
+    int skipped = 0;
+    int firstErrorLine = 0;     // relative to the chunk's first line
+    QString firstError;
+
+    void fail(int line, const QString &reason)
+    {
+        if (skipped++ == 0) {
+            firstErrorLine = line;
+            firstError = reason;
+        }
+    }
+};
+
+struct RawRecord {
+    QString fields[ColumnCount];
+};
+
+int columnForName(const QString &name)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == u"name")
+        return NameColumn;
+    if (key == u"description")
+        return DescriptionColumn;
+    if (key == u"priority")
+        return PriorityColumn;
+    if (key == u"status")
+        return StatusColumn;
+    if (key == u"created")
+        return CreatedColumn;
+    if (key == u"completed")
+        return CompletedColumn;
+    if (key == u"due")
+        return DueColumn;
+    if (key == u"reminder")
+        return ReminderColumn;
+    return -1;
+}
+
+bool parsePriority(const QString &text, TaskPriority &out)
+{
+    const QString key = text.trimmed().toLower();
+    if (key.isEmpty() || key == u"medium" || key == u"1")
+        out = MEDIUM;
+    else if (key == u"low" || key == u"0")
+        out = LOW;
+    else if (key == u"high" || key == u"2")
+        out = HIGH;
+    else
+        return false;
+    return true;
+}
+
+bool parseStatus(const QString &text, TaskStatus &out)
+{
+    const QString key = text.trimmed().toLower();
+    if (key.isEmpty() || key == u"pending" || key == u"0")
+        out = PENDING;
+    else if (key == u"in_progress" || key == u"in progress" || key == u"1")
+        out = IN_PROGRESS;
+    else if (key == u"completed" || key == u"done" || key == u"2")
+        out = COMPLETED;
+    else
+        return false;
+    return true;
+}
+
+// Empty text leaves outMs at 0
+bool parseTime(const QString &text, qint64 &outMs)
+{
+    const QString value = text.trimmed();
+    outMs = 0;
+    if (value.isEmpty())
+        return true;
+
+    bool isNumber = false;
+    const qint64 ms = value.toLongLong(&isNumber);
+    if (isNumber) {
+        outMs = ms;
+        return true;
+    }
+
+    const QDateTime time = QDateTime::fromString(value, Qt::ISODateWithMs);
+    if (!time.isValid())
+        return false;
+    outMs = time.toMSecsSinceEpoch();
+    return true;
+}
+
+// Validates one record and appends it to out; false with reason if malformed
+bool appendRecord(ParsedChunk &out, const RawRecord &record, qint64 nowMs, QString &reason)
+{
+    const QString &name = record.fields[NameColumn];
+    if (name.trimmed().isEmpty()) {
+        reason = QStringLiteral("missing name");
+        return false;
+    }
+
+    TaskPriority priority;
+    if (!parsePriority(record.fields[PriorityColumn], priority)) {
+        reason = QStringLiteral("unknown priority \"%1\"").arg(record.fields[PriorityColumn]);
+        return false;
+    }
+    TaskStatus status;
+    if (!parseStatus(record.fields[StatusColumn], status)) {
+        reason = QStringLiteral("unknown status \"%1\"").arg(record.fields[StatusColumn]);
+        return false;
+    }
+
+    qint64 createdMs = 0;
+    qint64 completedMs = 0;
+    if (!parseTime(record.fields[CreatedColumn], createdMs)) {
+        reason = QStringLiteral("bad created time \"%1\"").arg(record.fields[CreatedColumn]);
+        return false;
+    }
+    if (!parseTime(record.fields[CompletedColumn], completedMs)) {
+        reason = QStringLiteral("bad completed time \"%1\"").arg(record.fields[CompletedColumn]);
+        return false;
+    }
+    qint64 dueMs = 0;
+    qint64 reminderMs = 0;
+    if (!parseTime(record.fields[DueColumn], dueMs)) {
+        reason = QStringLiteral("bad due time \"%1\"").arg(record.fields[DueColumn]);
+        return false;
+    }
+    if (!parseTime(record.fields[ReminderColumn], reminderMs)) {
+        reason = QStringLiteral("bad reminder time \"%1\"").arg(record.fields[ReminderColumn]);
+        return false;
+    }
+    if (createdMs == 0)
+        createdMs = nowMs;
+    if (status != COMPLETED)
+        completedMs = 0;
+    else if (completedMs == 0)
+        completedMs = nowMs;
+
+    out.status.append(status);
+    out.priority.append(priority);
+    out.createdMs.append(createdMs);
+    out.completedMs.append(completedMs);
+    out.dueMs.append(dueMs);
+    out.reminderMs.append(reminderMs);
+    out.names.append(name);
+    out.descriptions.append(record.fields[DescriptionColumn]);
+    return true;
+}
+
+// Reads one CSV record from [pos, end) into fields and returns the position
+// after it. Line breaks inside quoted fields are counted in lines.
+qsizetype readCsvRecord(const char *data, qsizetype pos, qsizetype end,
+                        QVector<QByteArray> &fields, int &lines)
+{
+    fields.clear();
+    QByteArray field;
+    bool quoted = false;
+
+    while (pos < end) {
+        if (quoted) {
+            const char c = data[pos++];
+            if (c == '"') {
+                if (pos < end && data[pos] == '"') {
+                    field += '"';
+                    ++pos;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                if (c == '\n')
+                    ++lines;
+                field += c;
+            }
+            continue;
+        }
+
+        // Copy a run of plain bytes in one go
+        qsizetype run = pos;
+        while (run < end && data[run] != ',' && data[run] != '"'
+               && data[run] != '\n' && data[run] != '\r')
+            ++run;
+        field.append(data + pos, run - pos);
+        pos = run;
+        if (pos == end)
+            break;
+
+        const char c = data[pos++];
+        if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else if (c == '\n') {
+            ++lines;
+            break;
+        }
+        // '\r' is dropped
+    }
+    fields.append(field);
+    return pos;
+}
+
+ParsedChunk parseCsvChunk(const QByteArray &data, const Chunk &chunk,
+                          const QVector<int> &columns, qint64 nowMs)
+{
+    ParsedChunk out;
+    const char *bytes = data.constData();
+    QVector<QByteArray> fields;
+    QString reason;
+
+    qsizetype pos = chunk.begin;
+    while (pos < chunk.end) {
+        const int line = out.lines;
+        pos = readCsvRecord(bytes, pos, chunk.end, fields, out.lines);
+        if (fields.size() == 1 && fields.first().isEmpty())
+            continue;   // blank line
+
+        RawRecord record;
+        for (int i = 0; i < fields.size() && i < columns.size(); ++i) {
+            if (columns.at(i) >= 0)
+                record.fields[columns.at(i)] = QString::fromUtf8(fields.at(i));
+        }
+        if (!appendRecord(out, record, nowMs, reason))
+            out.fail(line, reason);
+    }
+    return out;
+}
+
+ParsedChunk parseJsonLinesChunk(const QByteArray &data, const Chunk &chunk, qint64 nowMs)
+{
+    ParsedChunk out;
+    const char *bytes = data.constData();
+    QString reason;
+
+    qsizetype pos = chunk.begin;
+    while (pos < chunk.end) {
+        const void *newline = std::memchr(bytes + pos, '\n', size_t(chunk.end - pos));
+        const qsizetype lineEnd = newline ? static_cast<const char *>(newline) - bytes : chunk.end;
+        const QByteArray line = QByteArray::fromRawData(bytes + pos, lineEnd - pos).trimmed();
+        const int lineNumber = out.lines;
+        pos = lineEnd + 1;
+        if (newline)
+            ++out.lines;
+        if (line.isEmpty())
+            continue;
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (!doc.isObject()) {
+            out.fail(lineNumber, error.error != QJsonParseError::NoError
+                                     ? error.errorString()
+                                     : QStringLiteral("not a JSON object"));
+            continue;
+        }
+
+        RawRecord record;
+        const QJsonObject object = doc.object();
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            const int column = columnForName(it.key());
+            if (column < 0)
+                continue;
+            const QJsonValue value = it.value();
+            if (value.isString())
+                record.fields[column] = value.toString();
+            else if (value.isDouble())
+                record.fields[column] = QString::number(value.toInteger());
+        }
+        if (!appendRecord(out, record, nowMs, reason))
+            out.fail(lineNumber, reason);
+    }
+    return out;
+}
+
+// Cuts [begin, size) into chunks that each end on a record boundary. In CSV
+// a line break only ends a record outside quotes, so that needs a full scan.
+QVector<Chunk> splitChunks(const QByteArray &data, qsizetype begin, TaskTransfer::Format format)
+{
+    const qsizetype size = data.size();
+    const int workers = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const qsizetype target = qMax(MinChunkBytes, (size - begin) / (workers * 4) + 1);
+    const char *bytes = data.constData();
+
+    QVector<Chunk> chunks;
+    qsizetype start = begin;
+    if (format == TaskTransfer::JsonLines) {
+        while (size - start > target) {
+            const void *newline = std::memchr(bytes + start + target, '\n',
+                                              size_t(size - start - target));
+            if (!newline)
+                break;
+            const qsizetype end = static_cast<const char *>(newline) - bytes + 1;
+            chunks.append({start, end});
+            start = end;
+        }
+    } else {
+        bool quoted = false;
+        for (qsizetype i = begin; i < size; ++i) {
+            const char c = bytes[i];
+            if (c == '"') {
+                quoted = !quoted;
+            } else if (c == '\n' && !quoted && i + 1 - start >= target) {
+                chunks.append({start, i + 1});
+                start = i + 1;
+            }
+        }
+    }
+    if (start < size)
+        chunks.append({start, size});
+    return chunks;
+}
+
+QString timeText(qint64 ms)
+{
+    if (ms == 0)
+        return QString();
+    return QDateTime::fromMSecsSinceEpoch(ms, QTimeZone::UTC).toString(Qt::ISODateWithMs);
+}
+
+void appendCsvField(QByteArray &out, const QString &text)
+{
+    const QByteArray bytes = text.toUtf8();
+    const bool needsQuotes = bytes.contains(',') || bytes.contains('"')
+                             || bytes.contains('\n') || bytes.contains('\r');
+    if (!needsQuotes) {
+        out += bytes;
+        return;
+    }
+    out += '"';
+    for (char c : bytes) {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+QByteArray formatRows(const TaskTable &table, int first, int last, TaskTransfer::Format format)
+{
+    QByteArray out;
+    out.reserve((last - first) * 96);
+    for (int row = first; row < last; ++row) {
+        if (format == TaskTransfer::Csv) {
+            out += QByteArray::number(table.id(row));
+            out += ',';
+            appendCsvField(out, table.name(row));
+            out += ',';
+            appendCsvField(out, table.description(row));
+            out += ',';
+            out += TaskTransfer::priorityName(table.priority(row)).toLatin1();
+            out += ',';
+            out += TaskTransfer::statusName(table.status(row)).toLatin1();
+            out += ',';
+            out += timeText(table.createdMs(row)).toLatin1();
+            out += ',';
+            out += timeText(table.completedMs(row)).toLatin1();
+            out += ',';
+            out += timeText(table.dueMs(row)).toLatin1();
+            out += ',';
+            out += timeText(table.reminderMs(row)).toLatin1();
+            out += '\n';
+        } else {
+            QJsonObject object;
+            object.insert(QStringLiteral("id"), qint64(table.id(row)));
+            object.insert(QStringLiteral("name"), table.name(row));
+            object.insert(QStringLiteral("description"), table.description(row));
+            object.insert(QStringLiteral("priority"), TaskTransfer::priorityName(table.priority(row)));
+            object.insert(QStringLiteral("status"), TaskTransfer::statusName(table.status(row)));
+            object.insert(QStringLiteral("created"), timeText(table.createdMs(row)));
+            if (table.completedMs(row) != 0)
+                object.insert(QStringLiteral("completed"), timeText(table.completedMs(row)));
+            if (table.dueMs(row) != 0)
+                object.insert(QStringLiteral("due"), timeText(table.dueMs(row)));
+            if (table.reminderMs(row) != 0)
+                object.insert(QStringLiteral("reminder"), timeText(table.reminderMs(row)));
+            out += QJsonDocument(object).toJson(QJsonDocument::Compact);
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+bool TaskTransfer::formatForPath(const QString &path, Format &outFormat)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == u"csv") {
+        outFormat = Csv;
+        return true;
+    }
+    if (suffix == u"jsonl" || suffix == u"ndjson") {
+        outFormat = JsonLines;
+        return true;
+    }
+    return false;
+}
+
+TaskTransfer::ImportResult TaskTransfer::importTasks(const QByteArray &data, Format format,
+                                                     TaskTable &table, TaskId &nextId)
+{
+    TASK_TRACE_SCOPE("TaskTransfer::importTasks");
+    ImportResult result;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+
+    // Spreadsheet exports often start with a UTF-8 byte order mark
+    qsizetype begin = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+
+    // The CSV header is read up front; it maps field positions to columns
+    int headerLines = 0;
+    QVector<int> columns;
+    if (format == Csv) {
+        QVector<QByteArray> header;
+        begin = readCsvRecord(data.constData(), begin, data.size(), header, headerLines);
+        for (const QByteArray &name : header)
+            columns.append(columnForName(QString::fromUtf8(name)));
+        if (!columns.contains(int(NameColumn))) {
+            result.ok = false;
+            result.firstError = QStringLiteral("line 1: header has no name column");
+            return result;
+        }
+    }
+
+    const QVector<Chunk> chunks = splitChunks(data, begin, format);
+    const QVector<ParsedChunk> parsed = QtConcurrent::blockingMapped<QVector<ParsedChunk>>(
+        chunks, [&](const Chunk &chunk) {
+            return format == Csv ? parseCsvChunk(data, chunk, columns, nowMs)
+                                 : parseJsonLinesChunk(data, chunk, nowMs);
+        });
+
+    int rows = 0;
+    for (const ParsedChunk &chunk : parsed)
+        rows += chunk.names.size();
+    table.reserve(table.size() + rows);
+
+    // Appending is sequential so IDs follow input order
+    int line = 1 + headerLines;
+    for (const ParsedChunk &chunk : parsed) {
+        for (int i = 0; i < chunk.names.size(); ++i) {
+            table.append(nextId++, chunk.status.at(i), chunk.priority.at(i),
+                         chunk.createdMs.at(i), chunk.completedMs.at(i),
+                         chunk.names.at(i), chunk.descriptions.at(i),
+                         chunk.dueMs.at(i), chunk.reminderMs.at(i));
+        }
+        if (chunk.skipped > 0 && result.skipped == 0) {
+            result.firstError = QStringLiteral("line %1: %2")
+                                    .arg(line + chunk.firstErrorLine)
+                                    .arg(chunk.firstError);
+        }
+        result.imported += chunk.names.size();
+        result.skipped += chunk.skipped;
+        line += chunk.lines;
+    }
+    return result;
+}
+
+bool TaskTransfer::exportTasks(const TaskTable &table, Format format, QIODevice &out)
+{
+    TASK_TRACE_SCOPE("TaskTransfer::exportTasks");
+    if (format == Csv && out.write("id,name,description,priority,status,created,completed,due,reminder\n") < 0)
+        return false;
+
+    // Rows are formatted in parallel a few chunks at a time, so memory stays
+    // bounded while output order is preserved
+    const int wave = qMax(1, QThreadPool::globalInstance()->maxThreadCount()) * 2;
+    QVector<int> starts;
+    for (int first = 0; first < table.size(); first += ExportChunkRows * wave) {
+        starts.clear();
+        for (int i = 0; i < wave && first + i * ExportChunkRows < table.size(); ++i)
+            starts.append(first + i * ExportChunkRows);
+
+        const QVector<QByteArray> blocks = QtConcurrent::blockingMapped<QVector<QByteArray>>(
+            starts, [&](int start) {
+                return formatRows(table, start, qMin(start + ExportChunkRows, table.size()), format);
+            });
+        for (const QByteArray &block : blocks) {
+            if (out.write(block) != block.size())
+                return false;
+        }
+    }
+    return true;
+}
+
+QString TaskTransfer::priorityName(TaskPriority priority)
+{
+    switch (priority) {
+    case LOW: return QStringLiteral("low");
+    case MEDIUM: return QStringLiteral("medium");
+    case HIGH: return QStringLiteral("high");
+    }
+    return QString();
+}
+
+QString TaskTransfer::statusName(TaskStatus status)
+{
+    switch (status) {
+    case PENDING: return QStringLiteral("pending");
+    case IN_PROGRESS: return QStringLiteral("in_progress");
+    case COMPLETED: return QStringLiteral("completed");
+    }
+    return QString();
+}
@@ -0,0 +1,54 @@
+#ifndef TASKTRANSFER_H
+#define TASKTRANSFER_H
+
+#include <QByteArray>
+#include <QString>
+#include "Task.h"
+#include "TaskTable.h"
+
+class QIODevice;
+
+// Bulk conversion between a TaskTable and text formats, for seeding and
+// migrating boards without the GUI.
+//
+// CSV needs a header row naming its columns (name is required; description,
+// priority, status, created, completed, due and reminder are optional,
+// others are ignored). JSON Lines takes one object per line with the same keys.
+// Priority and status are labels ("high", "in_progress") or their numeric
+// values; times are ISO 8601 or milliseconds since the epoch. Imported
+// tasks always get fresh IDs, so an exported id column is ignored.
+//
+// Input is split into chunks at record boundaries and the chunks are parsed
+// in parallel on the global thread pool; rows keep their input order.
+class TaskTransfer
+{
+public:
+    enum Format {
+        Csv,
+        JsonLines
+    };
+
+    struct ImportResult {
+        int imported = 0;
+        int skipped = 0;        // malformed records
+        QString firstError;     // "line N: reason" for the first skipped record
+        bool ok = true;         // false if the input could not be read at all
+    };
+
+    // Format implied by a file name (.csv, .jsonl, .ndjson); false if unknown
+    static bool formatForPath(const QString &path, Format &outFormat);
+
+    // Parses data and appends the records to table, assigning IDs from nextId
+    // onwards. Names and descriptions are kept whole; text has no length
+    // limit.
+    static ImportResult importTasks(const QByteArray &data, Format format,
+                                    TaskTable &table, TaskId &nextId);
+
+    // Writes every row of table to out, in row order
+    static bool exportTasks(const TaskTable &table, Format format, QIODevice &out);
+
+    static QString priorityName(TaskPriority priority);
+    static QString statusName(TaskStatus status);
+};
+
+#endif // TASKTRANSFER_H
@@ -0,0 +1,91 @@
+#include "TraceCounterModel.h"
+#include <QUrl>
+
+TraceCounterModel::TraceCounterModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    m_timer.setInterval(500);
+    connect(&m_timer, &QTimer::timeout, this, &TraceCounterModel::refresh);
+}
+
+int TraceCounterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_counters.size();
+}
+
+QVariant TraceCounterModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_counters.size())
+        return QVariant();
+
+    const TaskTrace::CounterValues &counter = m_counters.at(index.row());
+    switch (role) {
+    case NameRole:
+        return counter.name;
+    case CallsRole:
+        return counter.calls;
+    case TotalMsRole:
+        return double(counter.totalNs) / 1e6;
+    case AverageUsRole:
+        return counter.calls ? double(counter.totalNs) / counter.calls / 1e3 : 0.0;
+    case MaxUsRole:
+        return double(counter.maxNs) / 1e3;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> TraceCounterModel::roleNames() const
+{
+    return {
+        {NameRole, "name"},
+        {CallsRole, "calls"},
+        {TotalMsRole, "totalMs"},
+        {AverageUsRole, "averageUs"},
+        {MaxUsRole, "maxUs"}
+    };
+}
+
+void TraceCounterModel::setActive(bool active)
+{
+    if (active == isActive())
+        return;
+
+    if (active) {
+        refresh();
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+    emit activeChanged();
+}
+
+void TraceCounterModel::setTracing(bool tracing)
+{
+    if (tracing == isTracing())
+        return;
+
+    TaskTrace::setEnabled(tracing);
+    emit tracingChanged();
+}
+
+void TraceCounterModel::refresh()
+{
+    // A handful of rows; a reset is simpler than diffing and just as cheap
+    beginResetModel();
+    m_counters = TaskTrace::counters();
+    endResetModel();
+}
+
+void TraceCounterModel::reset()
+{
+    TaskTrace::resetCounters();
+    refresh();
+}
+
+bool TraceCounterModel::saveTrace(const QString &path)
+{
+    const QUrl url(path);
+    return TaskTrace::writeChromeTrace(url.isLocalFile() ? url.toLocalFile() : path);
+}
@@ -0,0 +1,53 @@
+#ifndef TRACECOUNTERMODEL_H
+#define TRACECOUNTERMODEL_H
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+#include "TaskTrace.h"
+
+// TaskTrace counters as a list model for the in-app overlay. Refreshes
+// itself while active; `tracing` switches span recording on and off.
+class TraceCounterModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool tracing READ isTracing WRITE setTracing NOTIFY tracingChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        CallsRole,
+        TotalMsRole,
+        AverageUsRole,
+        MaxUsRole
+    };
+
+    explicit TraceCounterModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool isActive() const { return m_timer.isActive(); }
+    void setActive(bool active);
+
+    bool isTracing() const { return TaskTrace::isEnabled(); }
+    void setTracing(bool tracing);
+
+    Q_INVOKABLE void refresh();
+    Q_INVOKABLE void reset();
+    // Writes the recorded spans as Chrome trace JSON; path or file URL
+    Q_INVOKABLE bool saveTrace(const QString &path);
+
+signals:
+    void activeChanged();
+    void tracingChanged();
+
+private:
+    QTimer m_timer;
+    QVector<TaskTrace::CounterValues> m_counters;
+};
+
+#endif // TRACECOUNTERMODEL_H
@@ -0,0 +1,247 @@
+// Benchmarks for the task engine: store save/load, TaskManager mutations and
+// lookups, and TaskListModel reads and change fan-out on synthetic boards.
+// The model benchmarks go through TaskEngine's worker thread like the app.
+//
+// Runs headless. Board sizes default to 1k, 100k and 1M tasks; set
+// TASK_BENCH_MAX_ROWS to cap them on slower machines. For regression
+// tracking use QtTest's machine-readable output, e.g.
+//     TaskBenchmarks -o results.xml,xml
+//     TaskBenchmarks -o results.csv,csv
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "TaskManager.h"
+#include "TaskEngine.h"
+#include "TaskStore.h"
+#include "TaskListModel.h"
+#include "TaskStatusFilterModel.h"
+
+class TaskBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void storeSave_data() { boardSizes(); }
+    void storeSave();
+    void storeLoad_data() { boardSizes(); }
+    void storeLoad();
+
+    void addTask_data() { boardSizes(); }
+    void addTask();
+    void getTaskById_data() { boardSizes(); }
+    void getTaskById();
+    void sortByPriority_data() { boardSizes(); }
+    void sortByPriority();
+
+    void modelData_data() { boardSizes(); }
+    void modelData();
+    void statusChangeFanOut_data() { boardSizes(); }
+    void statusChangeFanOut();
+
+private:
+    QTemporaryDir m_dir;
+
+    void boardSizes();
+    QString pathFor(int rows) const;
+    static void fill(TaskManager &manager, int rows);
+    // Saves a filled board and loads it into model through engine
+    void loadBoard(TaskEngine &engine, TaskListModel &model, int rows);
+};
+
+void TaskBenchmarks::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void TaskBenchmarks::boardSizes()
+{
+    QTest::addColumn<int>("rows");
+
+    const int maxRows = qEnvironmentVariableIsSet("TASK_BENCH_MAX_ROWS")
+                            ? qEnvironmentVariableIntValue("TASK_BENCH_MAX_ROWS")
+                            : 1000000;
+    for (int rows : {1000, 100000, 1000000}) {
+        if (rows <= maxRows)
+            QTest::newRow(qPrintable(QString::number(rows))) << rows;
+    }
+}
+
+QString TaskBenchmarks::pathFor(int rows) const
+{
+    return m_dir.filePath(QStringLiteral("board-%1.dat").arg(rows));
+}
+
+void TaskBenchmarks::fill(TaskManager &manager, int rows)
+{
+    // Deterministic mix of priorities, statuses and text lengths
+    QVector<TaskManager::NewTask> drafts;
+    drafts.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        TaskManager::NewTask draft;
+        draft.name = QStringLiteral("Task %1").arg(i);
+        draft.description = QStringLiteral("Synthetic description for benchmark task number %1").arg(i);
+        draft.priority = static_cast<TaskPriority>(i % 3);
+        drafts.append(draft);
+    }
+    const QVector<TaskId> ids = manager.addTasks(drafts);
+
+    QVector<TaskId> inProgress, completed;
+    for (int i = 0; i < ids.size(); ++i) {
+        if (i % 3 == 1)
+            inProgress.append(ids[i]);
+        else if (i % 3 == 2)
+            completed.append(ids[i]);
+    }
+    manager.setStatus(inProgress, IN_PROGRESS);
+    manager.setStatus(completed, COMPLETED);
+}
+
+void TaskBenchmarks::loadBoard(TaskEngine &engine, TaskListModel &model, int rows)
+{
+    {
+        TaskManager manager(pathFor(rows));
+        fill(manager, rows);
+        QVERIFY(manager.save());
+    }
+
+    engine.load();
+    QTRY_COMPARE_WITH_TIMEOUT(model.count(), rows, 300000);
+}
+
+void TaskBenchmarks::storeSave()
+{
+    QFETCH(int, rows);
+
+    TaskManager manager(pathFor(rows));
+    fill(manager, rows);
+
+    TaskStore store;
+    const QString path = pathFor(rows);
+    QBENCHMARK {
+        QVERIFY(store.save(manager.tasks(), {}, TaskId(rows + 1), path));
+    }
+}
+
+void TaskBenchmarks::storeLoad()
+{
+    QFETCH(int, rows);
+
+    const QString path = pathFor(rows);
+    {
+        TaskManager manager(path);
+        fill(manager, rows);
+        QVERIFY(manager.save());
+    }
+
+    TaskStore store;
+    TaskTable tasks;
+    QVector<TaskDependency> dependencies;
+    TaskId nextId = 0;
+    QBENCHMARK {
+        QVERIFY(store.load(path, tasks, dependencies, nextId));
+    }
+    QCOMPARE(tasks.size(), rows);
+}
+
+void TaskBenchmarks::addTask()
+{
+    QFETCH(int, rows);
+
+    TaskManager manager(pathFor(rows));
+    fill(manager, rows);
+
+    QBENCHMARK {
+        manager.addTask(QStringLiteral("Added"), QStringLiteral("Added during benchmark"), HIGH);
+    }
+}
+
+void TaskBenchmarks::getTaskById()
+{
+    QFETCH(int, rows);
+
+    TaskManager manager(pathFor(rows));
+    fill(manager, rows);
+
+    TaskId id = 1;
+    QBENCHMARK {
+        const Task task = manager.getTaskById(id);
+        Q_UNUSED(task);
+        id = id % TaskId(rows) + 1;
+    }
+}
+
+void TaskBenchmarks::sortByPriority()
+{
+    QFETCH(int, rows);
+
+    TaskManager manager(pathFor(rows));
+    fill(manager, rows);
+
+    // Alternate directions so every iteration really reorders
+    bool ascending = false;
+    QBENCHMARK {
+        manager.sortByPriority(ascending);
+        ascending = !ascending;
+    }
+}
+
+void TaskBenchmarks::modelData()
+{
+    QFETCH(int, rows);
+
+    TaskEngine engine(pathFor(rows));
+    TaskListModel model(&engine);
+    loadBoard(engine, model, rows);
+    model.fetchAll();
+
+    // One pass over every row and display role, as a full scroll would do
+    const QList<int> roles = model.roleNames().keys();
+    QBENCHMARK {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            const QModelIndex idx = model.index(row);
+            for (int role : roles)
+                model.data(idx, role);
+        }
+    }
+}
+
+void TaskBenchmarks::statusChangeFanOut()
+{
+    QFETCH(int, rows);
+
+    TaskEngine engine(pathFor(rows));
+    TaskListModel model(&engine);
+    loadBoard(engine, model, rows);
+
+    // The three Kanban columns plus the list's status filter
+    TaskStatusFilterModel all, pending, inProgress, completed;
+    all.setSourceModel(&model);
+    pending.setSourceModel(&model);
+    pending.setStatus(PENDING);
+    inProgress.setSourceModel(&model);
+    inProgress.setStatus(IN_PROGRESS);
+    completed.setSourceModel(&model);
+    completed.setStatus(COMPLETED);
+
+    // Move one task between columns: the command's round trip through the
+    // engine, then the change flush reaching the proxies
+    const TaskId id = model.tasks().id(0);
+    bool done = false;
+    QBENCHMARK {
+        if (done)
+            model.resetTask(qint64(id));
+        else
+            model.completeTask(qint64(id));
+        done = !done;
+
+        const TaskStatus expected = done ? COMPLETED : PENDING;
+        while (model.tasks().status(model.tasks().rowOf(id)) != expected)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_GUILESS_MAIN(TaskBenchmarks)
+#include "TaskBenchmarks.moc"
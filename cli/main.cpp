@@ -0,0 +1,146 @@
+// Headless import/export for task boards, e.g.
+//     TaskCli import backlog.csv
+//     TaskCli export board.jsonl --data /path/to/tasks.dat
+// Without --data it works on the same tasks.dat as the app.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QSaveFile>
+#include <QScopeGuard>
+#include <QFile>
+#include <QDir>
+#include <cstdio>
+#include "TaskStore.h"
+#include "TaskTable.h"
+#include "TaskTransfer.h"
+#include "TaskTrace.h"
+
+static int fail(const QString &message)
+{
+    std::fprintf(stderr, "%s\n", qPrintable(message));
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Same metadata as the app so the default data path matches
+    app.setOrganizationName("SyedSaifuddin045");
+    app.setApplicationName("TaskManager");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bulk import and export of tasks.dat boards.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "import or export");
+    parser.addPositionalArgument("file", "CSV or JSON Lines file; '-' exports to stdout");
+
+    QCommandLineOption dataOption("data", "Board file to use instead of the app's tasks.dat.", "path");
+    QCommandLineOption formatOption("format", "csv or jsonl; by default taken from the file name.", "format");
+    QCommandLineOption replaceOption("replace", "Import into an empty board instead of appending.");
+    QCommandLineOption threadsOption("threads", "Worker threads for parsing and formatting.", "count");
+    QCommandLineOption compressOption("compress", "Save the board in the compressed format.");
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the run to file.", "file");
+    parser.addOptions({dataOption, formatOption, replaceOption, threadsOption, compressOption, traceOption});
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2)
+        parser.showHelp(1);
+    const QString command = args.at(0);
+    const QString filePath = args.at(1);
+    if (command != "import" && command != "export")
+        return fail(QStringLiteral("Unknown command \"%1\"").arg(command));
+
+    TaskTransfer::Format format;
+    if (parser.isSet(formatOption)) {
+        const QString name = parser.value(formatOption).toLower();
+        if (name == "csv")
+            format = TaskTransfer::Csv;
+        else if (name == "jsonl" || name == "ndjson")
+            format = TaskTransfer::JsonLines;
+        else
+            return fail(QStringLiteral("Unknown format \"%1\"").arg(name));
+    } else if (!TaskTransfer::formatForPath(filePath, format)) {
+        return fail(QStringLiteral("Cannot tell the format of %1; pass --format").arg(filePath));
+    }
+
+    if (parser.isSet(threadsOption)) {
+        const int threads = parser.value(threadsOption).toInt();
+        if (threads > 0)
+            QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    }
+
+    QString dataPath = parser.value(dataOption);
+    if (dataPath.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        dataPath = dir + "/tasks.dat";
+    }
+
+    const QString tracePath = parser.value(traceOption);
+    TaskTrace::setEnabled(!tracePath.isEmpty());
+    const auto traceWriter = qScopeGuard([&tracePath]() {
+        if (!tracePath.isEmpty() && !TaskTrace::writeChromeTrace(tracePath))
+            std::fprintf(stderr, "Failed to write trace to %s\n", qPrintable(tracePath));
+    });
+
+    TaskStore store;
+    store.setCompressionEnabled(parser.isSet(compressOption));
+    TaskTable tasks;
+    QVector<TaskDependency> dependencies;   // carried through an import untouched
+    TaskId nextId = 1;
+    const bool replace = command == "import" && parser.isSet(replaceOption);
+    if (!replace && QFile::exists(dataPath) && !store.load(dataPath, tasks, dependencies, nextId))
+        return fail(QStringLiteral("Failed to load %1").arg(dataPath));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (command == "export") {
+        if (filePath == "-") {
+            QFile out;
+            if (!out.open(stdout, QIODevice::WriteOnly))
+                return fail("Cannot write to stdout");
+            if (!TaskTransfer::exportTasks(tasks, format, out))
+                return fail("Export failed");
+        } else {
+            QSaveFile out(filePath);
+            if (!out.open(QIODevice::WriteOnly))
+                return fail(QStringLiteral("Cannot write %1: %2").arg(filePath, out.errorString()));
+            if (!TaskTransfer::exportTasks(tasks, format, out) || !out.commit())
+                return fail(QStringLiteral("Export to %1 failed").arg(filePath));
+        }
+        std::fprintf(stderr, "Exported %d tasks in %lld ms\n", tasks.size(), timer.elapsed());
+        return 0;
+    }
+
+    QFile in(filePath);
+    if (!in.open(QIODevice::ReadOnly))
+        return fail(QStringLiteral("Cannot read %1: %2").arg(filePath, in.errorString()));
+
+    // Parse straight out of the page cache where possible
+    QByteArray data;
+    if (const uchar *mapped = in.map(0, in.size()))
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), in.size());
+    else
+        data = in.readAll();
+
+    const TaskTransfer::ImportResult result = TaskTransfer::importTasks(data, format, tasks, nextId);
+    if (!result.ok)
+        return fail(QStringLiteral("%1: %2").arg(filePath, result.firstError));
+    if (result.skipped > 0) {
+        std::fprintf(stderr, "Skipped %d malformed records (first at %s)\n",
+                     result.skipped, qPrintable(result.firstError));
+    }
+
+    if (!store.save(tasks, dependencies, nextId, dataPath))
+        return fail(QStringLiteral("Failed to save %1").arg(dataPath));
+
+    std::fprintf(stderr, "Imported %d tasks into %s in %lld ms\n",
+                 result.imported, qPrintable(dataPath), timer.elapsed());
+    return 0;
+}
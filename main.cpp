@@ -1,31 +1,77 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QStandardPaths>
 #include <QDir>
-#include "TaskManager.h"
+#include "TaskEngine.h"
 #include "TaskListModel.h"
 #include "Task.h"
+#include "TaskTrace.h"
+
+// --startup-profile: one line per startup phase, in ms since main() began
+static void reportPhase(const QElapsedTimer &clock, const char *phase, qint64 since)
+{
+    const qint64 now = clock.elapsed();
+    qInfo().noquote() << QStringLiteral("startup: %1 %2 ms (at %3 ms)")
+                             .arg(QLatin1String(phase), -16).arg(now - since).arg(now);
+}
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer clock;
+    clock.start();
+
     QGuiApplication app(argc, argv);
 
     // Set application metadata
     app.setOrganizationName("SyedSaifuddin045");
     app.setApplicationName("TaskManager");
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption profileOption("startup-profile",
+                                     "Print the time spent loading the board, creating the engines and drawing the first frame.");
+    parser.addOption(profileOption);
+    parser.process(app);
+    const bool profile = parser.isSet(profileOption);
+    if (profile)
+        reportPhase(clock, "application", 0);
+
     // Determine save file path
     QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir().mkpath(dataPath);
     QString filePath = dataPath + "/tasks.dat";
 
-    // Create manager and model
-    TaskManager *manager = new TaskManager(filePath, &app);
-    TaskListModel *model = new TaskListModel(manager, &app);
+    // The engine owns the tasks on its own thread; the model mirrors them
+    qint64 phaseStart = clock.elapsed();
+    TaskEngine *taskEngine = new TaskEngine(filePath, &app);
+    TaskListModel *model = new TaskListModel(taskEngine, &app);
+
+    // Log each change to a journal instead of rewriting tasks.dat on save
+    taskEngine->setJournalEnabled(true);
+    // Pick up what other instances, or scripts, write to the same file
+    taskEngine->setLiveSyncEnabled(true);
+    // Compressed, checksummed snapshots; older files still load
+    taskEngine->setCompressionEnabled(true);
+
+    // TASKMANAGER_TRACE=<file> records spans from startup and writes them
+    // as Chrome trace JSON on exit
+    const QString tracePath = qEnvironmentVariable("TASKMANAGER_TRACE");
+    if (!tracePath.isEmpty()) {
+        TaskTrace::setEnabled(true);
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [tracePath]() {
+            if (!TaskTrace::writeChromeTrace(tracePath))
+                qWarning() << "Failed to write trace to" << tracePath;
+        });
+    }
 
-    // Try to load existing tasks
-    manager->load();
+    if (profile) {
+        reportPhase(clock, "task engine", phaseStart);
+        phaseStart = clock.elapsed();
+    }
 
     QQmlApplicationEngine engine;
 
@@ -47,5 +93,29 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    if (profile) {
+        reportPhase(clock, "qml engine", phaseStart);
+
+        // Counted from here, since the frame is drawn while the board loads
+        const qint64 shownAt = clock.elapsed();
+        if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst())) {
+            QObject::connect(window, &QQuickWindow::frameSwapped, &app, [&clock, shownAt]() {
+                reportPhase(clock, "first frame", shownAt);
+            }, Qt::SingleShotConnection);
+        }
+
+        const qint64 loadAt = clock.elapsed();
+        QObject::connect(taskEngine, &TaskEngine::loadingChanged, &app,
+                         [&clock, taskEngine, loadAt, reported = false]() mutable {
+            if (reported || taskEngine->isLoading())
+                return;
+            reported = true;
+            reportPhase(clock, "store load", loadAt);
+        });
+    }
+
+    // Load existing tasks in the background so the window shows right away
+    taskEngine->loadAsync();
+
     return app.exec();
 }